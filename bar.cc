@@ -1,5 +1,6 @@
 #include "bar.h"
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <cmath>
@@ -26,7 +27,9 @@ void LoadingBar::inc() {
 void LoadingBar::show() const {
     std::cout << "[";
 
-    size_t cur_c = floor(LOADINGBAR_W * ((double)cur/max));
+    // (Nothing to do is as good as done)
+    size_t cur_c = LOADINGBAR_W;
+    if(max) cur_c = floor(LOADINGBAR_W * std::min(1.0, (double)cur/max));
     size_t rest = LOADINGBAR_W - cur_c;
 
     std::cout << std::string(cur_c, '=');
@@ -1,3 +1,6 @@
+// The progress bar the command line program draws on the console, the
+// library itself only reports progress through a ProgressFn
+
 #ifndef bar_h
 #define bar_h
 
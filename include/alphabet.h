@@ -0,0 +1,57 @@
+// An Alphabet is the set of letters a dictionary actually uses, in the
+// order of their code points. Words come in and go out as UTF-8, but
+// inside the solver letter i of the alphabet is the single byte
+// LETTER_BASE + i. That way every word is one byte per letter, whatever
+// the script, and tables indexed by letter only need size() entries.
+// For a dictionary that uses all of a-z, both forms are the same
+
+#ifndef alphabet_h
+#define alphabet_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// The byte that stands for the first letter of an alphabet
+#define LETTER_BASE 'a'
+// Most letters an alphabet can have, one bit each in an lmask_t
+#define MAX_ALPHABET_C 64
+
+// Bit n is set if the n'th letter of the alphabet is in there
+using lmask_t = uint64_t;
+
+// Index in the alphabet of a letter stored as a byte
+inline size_t letter_index(char c) { return (uint8_t) c - LETTER_BASE; }
+
+// The letters of a UTF-8 word, in lower case. Empty if the word is not
+// valid UTF-8 or has anything but (Latin, Greek or Cyrillic) letters
+std::u32string letters_of(std::string_view word);
+
+
+class Alphabet {
+    public:
+        Alphabet() = default;
+        // All distinct letters in letters (which may repeat).
+        // Throws if there are more than MAX_ALPHABET_C of them
+        Alphabet(std::u32string letters);
+
+        size_t size() const { return letters.size(); }
+
+        // The inner form of a word. Throws if it has letters not in here
+        std::string encode(const std::u32string& word) const;
+        std::string encode(std::string_view utf8) const;
+
+        // Turns the inner form back into UTF-8. Anything that is not a
+        // letter of the alphabet (like a '.') is copied as is
+        std::string decode(std::string_view word) const;
+
+        // All letters, as UTF-8
+        std::string utf8() const;
+
+    private:
+        // Sorted, so the inner forms sort like the words do
+        std::u32string letters;
+};
+
+#endif
@@ -0,0 +1,12 @@
+// Everything needed to embed the solver, as built into libbrutefordle.
+// None of it writes to the console, progress is reported through the 
+// (optional) callback in SolveOptions. WordleSolvers that share one 
+// Dictionary can be used from different threads at the same time.
+
+#ifndef brutefordle_h
+#define brutefordle_h
+
+#include "dictionary.h"
+#include "solver.h"
+
+#endif
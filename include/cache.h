@@ -0,0 +1,58 @@
+// The ResultCache keeps the results of recent calculations, by the
+// fingerprint of what they were about: the dictionary (which is also the
+// pool of guesses), the candidates left, what is known so far, and how
+// the guesses were scored. A round that comes up again, in this game or
+// any other that shares the cache, gets its answer right away. 
+//
+// Optionally every result is also appended to a file, from which the
+// cache is filled again when it gets created. Can be used from several
+// threads at once
+
+#ifndef cache_h
+#define cache_h
+
+#include "solver.h"
+
+#include <cstddef>
+#include <fstream>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+
+class ResultCache {
+    public:
+        // Keeps at most capacity results, dropping the least recently 
+        // used. If filename is not empty, results persist in that file
+        ResultCache(size_t capacity, const std::string& filename = "");
+
+        // The result stored under key, if there is one
+        std::optional<SolveResult> find(const std::string& key);
+
+        void store(const std::string& key, const SolveResult& res);
+
+    private:
+        // Adds to the front, and drops whatever does not fit anymore
+        void insert(const std::string& key, const SolveResult& res);
+
+        // Reads all results in filename, and compacts it if needed
+        void load(const std::string& filename);
+
+        std::mutex lock;
+        const size_t capacity;
+
+        // Most recently used first, and where each key is in there
+        std::list<std::pair<std::string, SolveResult>> entries;
+        std::unordered_map<
+            std::string, 
+            std::list<std::pair<std::string, SolveResult>>::iterator
+        > index;
+
+        // Results get appended to this, if there is a file
+        std::ofstream out;
+};
+
+#endif
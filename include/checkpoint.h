@@ -0,0 +1,57 @@
+// A Checkpoint keeps the accumulators of the guesses that have been
+// worked out so far in a file, so that a long calculation that gets
+// interrupted can pick up where it left off. Writing happens on a 
+// background thread, the calculation only hands over a copy
+
+#ifndef checkpoint_h
+#define checkpoint_h
+
+#include "evaltree.h"
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+
+
+class Checkpoint {
+    public:
+        // key identifies the calculation, results saved under any other
+        // key are ignored. Writes at most once every interval seconds
+        Checkpoint(std::string filename, std::string key, double interval);
+
+        // Writes whatever was handed over last, and stops the writer
+        ~Checkpoint();
+
+        // The accumulators saved by an earlier run, if any
+        std::map<std::string, Accumulator> load() const;
+
+        // Hands over the accumulators of all guesses done so far. They
+        // are only written if the interval has passed, or if forced
+        void update(
+            const std::map<std::string, Accumulator>& done, bool force = false
+        );
+
+    private:
+        // Runs on the writer thread
+        void write_loop();
+        void write(const std::map<std::string, Accumulator>& acc) const;
+
+        const std::string filename;
+        const std::string key;
+        const std::chrono::duration<double> interval;
+        std::chrono::steady_clock::time_point last_update;
+
+        std::mutex lock;
+        std::condition_variable changed;
+        // The latest accumulators that have not been written yet
+        std::map<std::string, Accumulator> pending;
+        bool has_pending = false;
+        bool stopping = false;
+
+        std::thread writer;
+};
+
+#endif
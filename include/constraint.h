@@ -0,0 +1,56 @@
+// A Constraint is everything a set of letter evaluations says about the
+// answer, compiled into flat tables: the letters that can still be at 
+// each position, the letters that have to occur, and how often letters
+// may occur at most. A word is checked against all of it in one go, so
+// filtering does not take a pass over the words for every LetterEval
+
+#ifndef constraint_h
+#define constraint_h
+
+#include "dictionary.h"
+#include "lguess.h"
+#include "wordtable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+
+class Constraint {
+    public:
+        Constraint();
+
+        // Adds what a single letter evaluation says
+        void add(const LetterEval& e);
+
+        // True if nothing was added yet
+        bool empty() const { return !positions && !counted; }
+
+        // True if a word, with these letter counts and mask, fits
+        bool matches(
+            const char* word, const uint8_t* counts, lmask_t mask
+        ) const;
+
+        // Moves the words (indices into t) in [first, last) that fit to
+        // the front, and returns where they end. Only reorders the range
+        uint32_t* partition(
+            uint32_t* first, uint32_t* last, const WordTable& t
+        ) const;
+
+    private:
+        // Bit l is set if letter l can still be at that position,
+        // for the positions that have their bit set in positions
+        lmask_t allowed[MAX_WORD_LENGTH];
+        uint64_t positions;
+
+        // Letters that have to occur at least once
+        lmask_t present;
+        // How often each letter may occur at most,
+        // for the letters that have their bit set in counted
+        uint8_t max_c[MAX_ALPHABET_C];
+        lmask_t counted;
+};
+
+#endif
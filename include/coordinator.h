@@ -0,0 +1,85 @@
+// The Coordinator splits the guesses of a round into shards, has them
+// worked out by other processes through a Transport, and merges their
+// results. Finished shards are kept in a work directory, so a job that
+// gets interrupted only redoes the shards that had not finished yet
+
+#ifndef coordinator_h
+#define coordinator_h
+
+#include "shard.h"
+#include "solver.h"
+#include "progress.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Attempts per shard before the whole job fails
+#define SHARD_ATTEMPTS 3
+
+
+// Runs a shard somewhere, and returns its output
+class Transport {
+    public:
+        virtual ~Transport() {}
+        virtual std::string run(const ShardJob& job) = 0;
+};
+
+// Runs `command shard <job>` as a child process, and reads its stdout.
+// The command can be this executable, or something like "ssh host bf"
+class PipeTransport : public Transport {
+    public:
+        PipeTransport(std::vector<std::string> command);
+        std::string run(const ShardJob& job);
+
+    private:
+        const std::vector<std::string> command;
+};
+
+// Sends the job to a worker listening on host:port (see serve_shards)
+class TcpTransport : public Transport {
+    public:
+        TcpTransport(std::string host, uint16_t port);
+        std::string run(const ShardJob& job);
+
+    private:
+        const std::string host;
+        const uint16_t port;
+};
+
+
+class Coordinator {
+    public:
+        Coordinator(
+            ShardJob job,                   // index and count are ignored
+            size_t shards,                  // amount of shards
+            std::vector<std::unique_ptr<Transport>> transports,
+            std::string work_dir            // where finished shards go
+        );
+
+        // Runs all shards that are not finished yet, jobs at a time, 
+        // spreading them over the transports. Merges all their results
+        SolveResult run(size_t jobs, size_t top_n, ProgressFn progress);
+
+    private:
+        // Runs shard i, retrying on other transports if it fails, 
+        // and stores its (complete) output in the work directory
+        void finish_shard(size_t i);
+
+        // Reads the output of shard i, if it finished before
+        bool load_shard(size_t i, std::map<std::string, Accumulator>& res);
+
+        // The file that holds the output of shard i
+        std::string shard_file(size_t i) const;
+        // Identifies the job, so results of other jobs are not reused
+        std::string job_line() const;
+
+        const ShardJob job;
+        const size_t shards;
+        const std::vector<std::unique_ptr<Transport>> transports;
+        const std::string work_dir;
+};
+
+#endif
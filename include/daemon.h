@@ -0,0 +1,99 @@
+// The SolverDaemon keeps dictionaries and first round results in memory
+// and serves many games at once over a Unix domain socket. Each line a
+// client sends is one request, and gets exactly one line in response:
+//
+//   NEW [length]                   -> OK <session>
+//   GUESS <session> <word> <marks> -> OK <words left>
+//   SUGGEST <session> [n]          -> OK [PARTIAL] <word>:<score> ...
+//   LEFT <session> [n]             -> OK <words left> <word> ...
+//   END <session>                  -> OK
+//   QUIT                           -> closes the connection
+//
+// Sessions belong to the connection that started them, and are ended
+// when it closes. Anything that goes wrong is answered with ERR <reason>.
+// With a deadline, suggestions that are the best found in time are marked
+// PARTIAL
+
+#ifndef daemon_h
+#define daemon_h
+
+#include "solver.h"
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+
+class SolverDaemon {
+    public:
+        // All games keep their results in cache (if given). Suggestions
+        // take about deadline seconds at most, if it is not 0
+        SolverDaemon(
+            std::string dict_name, size_t default_wlen,
+            std::shared_ptr<ResultCache> cache = nullptr,
+            double deadline = 0
+        );
+
+        // Listens on the socket until the process is killed
+        void serve(const std::string& socket_path);
+
+        // Handles a single request line and returns the response line.
+        // If opened (the sessions of one connection) is given, only those
+        // sessions can be used, and the ones it starts or ends are kept
+        // up to date in there
+        std::string handle(
+            const std::string& request,
+            std::vector<std::string>* opened = nullptr
+        );
+
+    private:
+        // A game in progress
+        struct Session {
+            std::mutex lock;
+            WordleSolver solver;
+
+            Session(const WordleSolver& s) : solver(s) {}
+        };
+
+        // A loaded dictionary and its (lazily calculated) first round
+        struct Game {
+            std::mutex lock;
+            std::unique_ptr<WordleSolver> solver;
+            std::vector<Suggestion> opening;
+        };
+
+        // Serves one client until it disconnects
+        void serve_client(int fd);
+
+        // Returns the pristine solver for this length, loading it if needed
+        Game& game(size_t wlen);
+
+        std::shared_ptr<Session> session(const std::string& id);
+
+        std::string new_game(
+            std::istream& args, std::vector<std::string>* opened
+        );
+        std::string guess(std::istream& args);
+        std::string suggest(std::istream& args);
+        std::string left(std::istream& args);
+        std::string end(std::istream& args);
+
+        const std::string dict_name;
+        const size_t default_wlen;
+        const std::shared_ptr<ResultCache> cache;
+        const double deadline;
+
+        // Loaded dictionaries, by word length
+        std::mutex games_lock;
+        std::map<size_t, std::unique_ptr<Game>> games;
+
+        // Games in progress, by session id
+        std::mutex sessions_lock;
+        std::map<std::string, std::shared_ptr<Session>> sessions;
+        size_t next_session = 1;
+};
+
+#endif
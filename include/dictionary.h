@@ -0,0 +1,104 @@
+// The Dictionary class holds all words of a single length in one flat
+// buffer, together with some per-word indexes. It is either read from a
+// plain text word list, or memory mapped straight from a binary file
+// written by Dictionary::compile (see the `compile` subcommand). The
+// words are stored in the inner form of their alphabet, see alphabet.h
+
+#ifndef dictionary_h
+#define dictionary_h
+
+#include "alphabet.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Longest words a dictionary (compiled or not) can hold
+#define MAX_WORD_LENGTH 64
+
+
+// Counts how often each letter occurs in word (into counts, which has
+// an entry per letter of the alphabet) and returns the mask of letters
+lmask_t letter_counts(const char* word, size_t wlen, uint8_t* counts);
+
+
+class Dictionary {
+    public:
+        // Reads the words of length wlen from either a text dictionary
+        // or a compiled one. Compiled ones are detected by their header
+        static std::shared_ptr<const Dictionary> load(
+            const std::string& filename, size_t wlen
+        );
+
+        // Reads a text dictionary and writes all its words, partitioned
+        // by length and with precomputed indexes, to a binary file
+        static void compile(
+            const std::string& in_file, const std::string& out_file
+        );
+
+        Dictionary(const Dictionary&) = delete;
+        Dictionary& operator=(const Dictionary&) = delete;
+        ~Dictionary();
+
+        // Amount of words and the length of each of them
+        size_t size() const { return count; }
+        size_t length() const { return wlen; }
+
+        // The letters the words of this length use
+        const Alphabet& alphabet() const { return alpha; }
+
+        // In the inner form, see Alphabet::decode
+        std::string_view word(size_t i) const {
+            return std::string_view(words + i*wlen, wlen);
+        }
+
+        // How often each letter of the alphabet occurs in word i
+        const uint8_t* counts(size_t i) const {
+            return letter_counts + i*alpha.size();
+        }
+
+        // Bit n is set if the n'th letter of the alphabet is in word i
+        lmask_t mask(size_t i) const { return masks[i]; }
+
+        // The (sorted) indices of all words with letter l at position p
+        std::span<const uint32_t> with_letter_at(size_t p, char l) const;
+
+    private:
+        Dictionary() = default;
+
+        // Reads a text file and stores the words of length wlen
+        void read_text(const std::string& filename, size_t wlen);
+        // Maps a compiled file and points into the section for wlen
+        bool map_compiled(const std::string& filename, size_t wlen);
+
+        size_t wlen = 0;
+        size_t count = 0;
+        Alphabet alpha;
+
+        // These point either into the owned buffers below
+        // or into the memory mapped region of a compiled file
+        const char* words = nullptr;
+        const uint8_t* letter_counts = nullptr;
+        const lmask_t* masks = nullptr;
+        // Compressed rows: words with letter l at position p are in
+        // pos_words[pos_offsets[p*alpha.size()+l] .. pos_offsets[..+1]]
+        const uint32_t* pos_offsets = nullptr;
+        const uint32_t* pos_words = nullptr;
+
+        // Only used for text dictionaries
+        std::string own_words;
+        std::vector<uint8_t> own_counts;
+        std::vector<lmask_t> own_masks;
+        std::vector<uint32_t> own_offsets;
+        std::vector<uint32_t> own_pos;
+
+        // Only used for compiled dictionaries
+        void* mapping = nullptr;
+        size_t mapping_size = 0;
+};
+
+#endif
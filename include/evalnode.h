@@ -24,10 +24,11 @@ class EvalNode {
         EvalNode();
 
         size_t size() const;
-        void print(const int depth) const;
+        void print(std::ostream& s, const int depth) const;
         void insert(
             std::vector<std::unique_ptr<const LetterEval>>& q, 
-            const size_t idx
+            const size_t idx,
+            const size_t m
         );
         
         std::map<
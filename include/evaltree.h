@@ -5,8 +5,12 @@
 #ifndef wordtree_h
 #define wordtree_h
 
-#include "bar.h"
+#include "constraint.h"
 #include "evalnode.h"
+#include "kernels.h"
+#include "progress.h"
+#include "tiling.h"
+#include "wordtable.h"
 
 #include <cstddef>
 #include <memory>
@@ -16,42 +20,111 @@
 
 using scoremap = std::map<double, std::list<std::string>>;
 
+// Rough size of a node in the tree: its map entry, the EvalNode
+// and the LetterEval, including what malloc adds to each
+#define TREE_NODE_BYTES 160
+// Rough size of an entry in the elims map
+#define ELIM_BYTES 96
+
+// A guess together with the avg amount of words left after making it
+struct Suggestion {
+    std::string word;
+    double score;
+};
+
+// Keeps the average of a (large) list of numbers
+struct Accumulator {
+    size_t total; // sum of all numbers
+    size_t count; // amount of numbers
+
+    // adds c times t to this Accumulator
+    void add(size_t t, size_t c) {
+        total += c * t;
+        count += c;
+    }
+
+    // Adds all numbers of another Accumulator
+    void merge(const Accumulator& a) {
+        total += a.total;
+        count += a.count;
+    }
+
+    // Returns the avg of the numbers so far
+    double avg() const { return (double) total / count; }
+};
+
+// Writes accumulators one "<guess> <total> <count>" per line, followed
+// by "END <lines>", so a reader can tell that the list is complete
+void write_accumulators(
+    std::ostream& out, const std::map<std::string, Accumulator>& acc
+);
+
+// Reads what write_accumulators wrote, throws if it is not complete
+std::map<std::string, Accumulator> read_accumulators(std::istream& in);
+
+// The n guesses with the lowest averages, best first
+std::vector<Suggestion> best_of(
+    const std::map<std::string, Accumulator>& acc, size_t n
+);
+
 
 class EvalTree {
     public:
         EvalTree(
-            std::list<std::string>* wl,     // list of remaining words
-            std::list<std::string>* d,      // complete dictionary
-            std::string g                   // letters we got so far
+            const std::list<std::string>* wl,   // list of remaining words
+            const std::list<std::string>* d,    // complete dictionary
+            std::string g,                      // letters we got so far
+            const Kernels& k,                   // kernels for the length
+            ProgressFn progress = nullptr,      // progress reporting
+            Tiling tile = {}                    // tile sizes (0 is auto)
         );
+        ~EvalTree();
         
+        // The most bytes a tree for this many guesses and remaining 
+        // words of length wlen takes, if none of its paths are shared
+        static size_t footprint(
+            size_t guesses, size_t answers, size_t wlen, Tiling tile = {}
+        );
+
         // Returns the amount of leaf nodes in the tree
         size_t size() const;
 
         // Prints entire tree
         // Increases indentaion of nodes as depth increases
-        void print() const;
+        void print(std::ostream& s) const;
        
-        // Inserts a wordguess into the tree
+        // Inserts a wordguess into the tree multiplicity times
         // Increases the final leaf's multiplicity
         // field if it already exists
-        void insert(std::vector<std::unique_ptr<const LetterEval>>& q);
+        void insert(
+            std::vector<std::unique_ptr<const LetterEval>>& q,
+            const size_t multiplicity
+        );
 
-        // Sorts guesses on how many words are left and shows the best
-        void best_guesses() const;
+        // The n best guesses, best first
+        std::vector<Suggestion> ranking(size_t n) const;
 
-        // Shows the current guess, and how many remaining words 
-        // there are. If there are less than SHOW_LEFT_C (in .cc), 
-        // also prints the words and how many words are left if guessed
-        void show_remaining() const;
+        // All remaining words, and how many words are left if guessed
+        std::vector<Suggestion> candidates() const;
+
+        // How many words are left after each guess, per guess
+        const std::map<std::string, Accumulator>& accumulators() const {
+            return elims;
+        }
 
     private:
-        // Generates an evaluation of a guess against a word
+        // Turns the marks a guess got into letter evaluations
         std::vector<std::unique_ptr<const LetterEval>>
-        evaluate(const std::string& guess, std::string word);
+        evaluate(const std::string& guess, const uint8_t* marks);
+
+        // Sorts the guesses into the ones we work out, ones that
+        // score the same as one of those, and useless ones
+        void find_representatives();
 
         // Generates all possible evaluations
         void generate_evaluations();
+        // Same, for words too long to pack their feedback
+        void generate_long_evaluations();
 
         // For all these evalutions, calculates how
         // many words are left after applying. Calls get_e
@@ -59,11 +132,17 @@ class EvalTree {
         
         // Walks though all paths in the tree, calculating
         // how many words are left in the dictionary if the 
-        // guesses that said path represents would be made
+        // guesses that said path represents would be made.
+        // The evaluations since the last branch are collected in
+        // pending, and only get applied where paths split. The words 
+        // left are the range [first, last) of one array of indices, 
+        // which gets partitioned in place on the way down
         void get_e(
             std::string s, 
             const EvalNode* cur, 
-            const std::list<std::string>& d
+            uint32_t* first,
+            uint32_t* last,
+            Constraint& pending
         );
         
         // Holds the letters we already know are right
@@ -72,36 +151,37 @@ class EvalTree {
         const std::list<std::string>* dict;
         // All the words still in the running
         const std::list<std::string>* words_left;
+        // The same words, with their letter counts
+        const WordTable answers;
         const int wlen;
+        // The kernels compiled for wlen
+        const Kernels kern;
+        // Where to report progress to
+        const ProgressFn progress_fn;
+        // How to tile the guesses and answers
+        const Tiling tile;
         
+        // One guess for every way of splitting the remaining words
+        std::vector<const std::string*> representatives;
+        // Guesses that split them like a representative, and which one
+        std::vector<
+            std::pair<const std::string*, const std::string*>
+        > equivalent;
+        // Guesses without any letter of a remaining word
+        std::vector<const std::string*> uninformative;
+
         // Root of the tree
         const std::unique_ptr<EvalNode> root;
 
         // For each word, we keep a list of how many words
         // are left after filtering each evalution
-        struct Accumulator {
-            size_t total; // sum of all numbers
-            size_t count; // amount of numbers
-
-            // adds c times t to this Accumulator
-            void add(size_t t, size_t c) {
-                total += c * t;
-                count += c;
-            }
-
-            // Returns the avg of the numbers so far
-            double avg() { return (double) total / count; }
-        };
-
         std::map<std::string, Accumulator> elims;
         // The average of elims, in an inverted map structure
         std::unique_ptr<scoremap> scores;
-        // Easy lookup for leftover word scores
-        std::map<std::string, double> leftover_scores;
         
-        // Loading bar for get_e 
+        // Progress of the current phase
         // (avoids having to pass it in the recursion)
-        std::unique_ptr<LoadingBar> lbar;
+        std::unique_ptr<Progress> progress;
 };
 
 #endif
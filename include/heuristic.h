@@ -0,0 +1,24 @@
+// A cheap estimate of how good the guesses are, to only score the
+// promising ones exactly. Every letter of a guess splits the remaining
+// words into the ones with that letter in the same position, the ones
+// with it somewhere else, and the ones without it. The entropy of those
+// splits, summed over the positions, ranks the guesses. A letter that
+// occurs twice in a guess only counts for its position the second time.
+// Takes one pass over the remaining words, and one over the guesses
+
+#ifndef heuristic_h
+#define heuristic_h
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <vector>
+
+
+// All guesses, the most promising first (in their own order on ties)
+std::vector<const std::string*> heuristic_ranking(
+    const std::list<std::string>& guesses,
+    const std::list<std::string>& answers
+);
+
+#endif
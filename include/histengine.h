@@ -0,0 +1,54 @@
+// The HistEngine scores guesses without building a tree. The words that
+// are left after a guess are exactly the ones that got the same feedback,
+// so all it needs per guess is a histogram of the feedback codes: the avg
+// amount of words left is the sum of the squared bucket sizes over the 
+// amount of remaining words. That takes one pass over the remaining words
+// per guess, and the guesses are split over a number of threads.
+//
+// Buckets are exact, while the filters of the tree let some words through
+// that could not have given that feedback, so scores can be lower than 
+// those of the EvalTree. Only works for words of at most FCODE_MAX_LENGTH
+
+#ifndef histengine_h
+#define histengine_h
+
+#include "evaltree.h"
+#include "kernels.h"
+#include "progress.h"
+#include "tiling.h"
+
+#include <cstddef>
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
+
+class HistEngine {
+    public:
+        HistEngine(
+            const std::list<std::string>* wl,   // list of remaining words
+            const std::list<std::string>* d,    // guesses to score
+            const Kernels& k,                   // kernels for the length
+            ProgressFn progress = nullptr,      // progress reporting
+            size_t threads = 0,                 // 0 uses all cores
+            Tiling tile = {}                    // tile sizes (0 is auto)
+        );
+
+        // The n best guesses, best first
+        std::vector<Suggestion> ranking(size_t n) const;
+
+        // All remaining words, and how many words are left if guessed
+        std::vector<Suggestion> candidates() const;
+
+        // How many words are left after each guess, per guess
+        const std::map<std::string, Accumulator>& accumulators() const {
+            return elims;
+        }
+
+    private:
+        const std::list<std::string>* words_left;
+        std::map<std::string, Accumulator> elims;
+};
+
+#endif
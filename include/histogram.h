@@ -0,0 +1,76 @@
+// A Histogram counts how many words got each feedback code for a guess.
+// For short words it is a dense table of 3^wlen counters. That is not 
+// viable for long words, so those get a hash map instead, which only 
+// grows with the amount of distinct codes that actually show up
+
+#ifndef histogram_h
+#define histogram_h
+
+#include "kernels.h"
+#include "wordtable.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+// Most counters a dense histogram may have
+#define HIST_DENSE_MAX (1 << 20)
+
+
+class Histogram {
+    public:
+        Histogram(size_t wlen);
+
+        // True if words of length wlen get a dense table
+        static bool dense_viable(size_t wlen);
+
+        // Roughly how many bytes a histogram for words of length wlen
+        // takes when it has seen up to words different codes
+        static size_t footprint(size_t wlen, size_t words);
+
+        void add(fcode_t code) {
+            if(dense.empty()) { sparse[code]++; return; }
+
+            if(dense[code]++ == 0) touched.push_back(code);
+        }
+
+        // Forgets all counts (in time proportional to the amount of codes)
+        void clear();
+
+        // Amount of distinct codes seen
+        size_t buckets() const;
+
+        // How often code was seen
+        size_t count(fcode_t code) const;
+
+        // Calls fn(code, count) for every code seen
+        template<typename F>
+        void for_each(F fn) const {
+            if(dense.empty()) {
+                for(auto &[code, c] : sparse) fn(code, c);
+            }
+            else {
+                for(auto &code : touched) fn(code, dense[code]);
+            }
+        }
+
+    private:
+        // 3^wlen counters, and the codes whose counter is not 0
+        std::vector<uint32_t> dense;
+        std::vector<fcode_t> touched;
+
+        // Only used when dense is not viable
+        std::unordered_map<fcode_t, uint32_t> sparse;
+};
+
+
+// Adds the feedback of each of guess_c guesses (back to back in guesses)
+// for every word in answers to hists[i], in tiles of answer_tile answers.
+// Each tile stays in cache while all guesses get scored against it
+void fill_histograms(
+    Histogram* hists, const char* guesses, size_t guess_c,
+    const WordTable& answers, const Kernels& k, size_t answer_tile
+);
+
+#endif
@@ -0,0 +1,55 @@
+// The inner loops of the solver, compiled once for every common word
+// length so that the per letter loops have a fixed trip count. The
+// right set of kernels is picked once, from the word length, and used
+// through the function pointers in the Kernels struct
+
+#ifndef kernels_h
+#define kernels_h
+
+#include <cstddef>
+#include <cstdint>
+
+// The mark every position of a guess gets
+#define FB_WRONG 0
+#define FB_PLACE 1
+#define FB_RIGHT 2
+
+// Word lengths that get their own compiled kernels,
+// all others use (slower) generic ones
+#define KERNEL_MIN_LENGTH 4
+#define KERNEL_MAX_LENGTH 12
+
+// Longest word whose feedback still fits in an fcode_t
+#define FCODE_MAX_LENGTH 40
+
+// The feedback on a guess, packed into a single number:
+// position i contributes its mark times 3^i
+using fcode_t = uint64_t;
+
+
+struct Kernels {
+    // The word length, which all kernels below take as their last
+    // argument. The specialized ones have it compiled in and ignore it
+    size_t wlen;
+
+    // Packs the feedback of guessing guess when word is the answer.
+    // Only valid for words of at most FCODE_MAX_LENGTH letters
+    fcode_t (*feedback)(const char* guess, const char* word, size_t wlen);
+
+    // Same as feedback, but writes out one mark per position
+    void (*marks)(
+        const char* guess, const char* word, uint8_t* out, size_t wlen
+    );
+
+    // Unpacks a feedback code into one mark per position
+    void (*decode)(fcode_t code, uint8_t* out, size_t wlen);
+};
+
+
+// The kernels to use for words of length wlen
+Kernels kernels(size_t wlen);
+
+// Packs one mark per position into a feedback code
+fcode_t encode(const uint8_t* marks, size_t wlen);
+
+#endif
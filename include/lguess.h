@@ -2,7 +2,6 @@
 #define lguess_h
 
 #include <string>
-#include <list>
 #include <iostream>
 
 #define LGUESS_RIGHT 0
@@ -15,10 +14,6 @@ class LetterEval {
         LetterEval(int i, char l) : idx(i), letter(l) {}
         virtual ~LetterEval() {}
 
-        virtual void filter(
-            std::list<std::string>* const dict
-        ) const = 0;
-
         virtual std::ostream& print(std::ostream& s) const = 0;
         bool operator <(const LetterEval &g) const;
         
@@ -42,10 +37,6 @@ class EvalRight : public LetterEval {
 
         ~EvalRight(){}
         
-        void filter(
-            std::list<std::string>* const dict
-        ) const; 
-
         std::ostream& print(std::ostream& s) const;
 
 };
@@ -59,10 +50,6 @@ class EvalPlace : public LetterEval {
 
         ~EvalPlace(){}
         
-        void filter(
-            std::list<std::string>* const dict
-        ) const; 
-
         std::ostream& print(std::ostream& s) const;
 };
 
@@ -78,10 +65,6 @@ class EvalWrong : public LetterEval {
 
         ~EvalWrong(){}
         
-        void filter(
-            std::list<std::string>* const dict
-        ) const; 
-
         std::ostream& print(std::ostream& s) const;
 
         // The amount of "letter"s to allow
@@ -0,0 +1,98 @@
+// Opt-in accounting of the memory a calculation uses. The library does
+// not touch the global operator new and delete: a program that wants
+// the counts replaces them with ones that call memory_allocated and
+// memory_freed (the command line program does, see memhooks.cc). Those
+// only do a single check for as long as no MemoryTracker is alive.
+// While one is, every allocation is counted towards the phase that is
+// going on (the phases are the ones progress is reported for) and the
+// subsystem it was made in, which code marks with a MemoryScope. Frees
+// are counted towards the subsystem that made the allocation. Without
+// the hooks, reports only have the peak resident set size
+//
+// There is only one set of counters per process: calculations that run
+// at the same time as a tracked one get counted along with it
+
+#ifndef memstats_h
+#define memstats_h
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The subsystems allocations are counted towards
+#define MEM_OTHER 0
+// Word lists and WordTables
+#define MEM_WORDS 1
+// The maps of the EvalNodes in the tree
+#define MEM_TREE 2
+// The LetterEvals in the tree (and ones that are already in there)
+#define MEM_EVALS 3
+// The histograms of the guesses
+#define MEM_HIST 4
+// The amount of words left after each guess (the elims maps)
+#define MEM_ELIMS 5
+// Guesses sorted by score
+#define MEM_SCORES 6
+#define MEM_SUBSYSTEM_C 7
+
+
+// What got allocated in one phase, or by one subsystem
+struct MemoryUse {
+    std::string name;
+    // Amount of allocations, and the bytes they asked for in total
+    size_t allocs;
+    size_t bytes;
+    // Most bytes that were live at the same time (all subsystems
+    // together, for phases)
+    size_t peak;
+};
+
+struct MemoryReport {
+    // In the order they started
+    std::vector<MemoryUse> phases;
+    // The ones that allocated anything
+    std::vector<MemoryUse> subsystems;
+    // Peak resident set size of the process so far
+    size_t peak_rss;
+};
+
+
+// Counts allocations for as long as it lives. The counters start
+// from zero when there are no other MemoryTrackers
+class MemoryTracker {
+    public:
+        MemoryTracker();
+        ~MemoryTracker();
+
+        MemoryTracker(const MemoryTracker&) = delete;
+        MemoryTracker& operator=(const MemoryTracker&) = delete;
+
+        // Everything counted so far
+        MemoryReport report() const;
+};
+
+
+// Counts the allocations made on this thread towards a subsystem,
+// until it goes out of scope
+class MemoryScope {
+    public:
+        MemoryScope(int subsystem);
+        ~MemoryScope();
+
+        MemoryScope(const MemoryScope&) = delete;
+        MemoryScope& operator=(const MemoryScope&) = delete;
+
+    private:
+        const int previous;
+};
+
+
+// Counts the allocations from now on towards the phase called name
+void memory_phase(const std::string& name);
+
+// To be called by a replaced operator new and delete, with every
+// block they hand out (and the size asked for) and take back
+void memory_allocated(void* p, size_t n);
+void memory_freed(void* p);
+
+#endif
@@ -0,0 +1,61 @@
+// The MultiSolver plays several boards at once (Quordle, Octordle, ...),
+// where every guess is made on all boards. Each board keeps its own 
+// candidate words, but the feedback of a guess is only worked out once
+// per word, in a pattern row that all boards read from. Guesses are 
+// scored on all unsolved boards in the same pass.
+
+#ifndef multisolver_h
+#define multisolver_h
+
+#include "dictionary.h"
+#include "kernels.h"
+#include "solver.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+class MultiSolver {
+    public:
+        MultiSolver(std::shared_ptr<const Dictionary> d, size_t boards);
+
+        // Applies a guess to every board, with one string of marks per
+        // board. Marks for boards that are already solved are ignored
+        void update(
+            const std::string& word, const std::vector<std::string>& marks
+        );
+
+        // True once every board is solved, or has no words left
+        bool done() const;
+
+        // Ranks all words on the sum, over the unsolved boards, of the avg 
+        // amount of words that are left unresolved after guessing them.
+        // The candidates of the result are left empty, see remaining()
+        SolveResult calculate_best_guess(const SolveOptions& opts = {}) const;
+
+        size_t boards() const { return candidates.size(); }
+        bool solved(size_t board) const { return is_solved[board]; }
+
+        // The words that still fit the guesses made on a board so far
+        std::vector<std::string> remaining(size_t board) const;
+
+    private:
+        // Fills row with the feedback of guess g for every word that
+        // is still a candidate on any unsolved board
+        void fill_row(const char* g, std::vector<fcode_t>& row) const;
+
+        std::shared_ptr<const Dictionary> dict;
+        const size_t wlen;
+        const Kernels kern;
+
+        // Indices (into dict) of the words left, per board
+        std::vector<std::vector<uint32_t>> candidates;
+        std::vector<bool> is_solved;
+        // Indices of the words that are left on any unsolved board
+        std::vector<uint32_t> any_board;
+};
+
+#endif
@@ -0,0 +1,51 @@
+// The compute loops never write to the console themselves. Instead they
+// report how far along they are to an (optional) callback, through the
+// Progress class, which takes care of not calling it too often.
+// A calculation gets cancelled by throwing Cancelled out of the callback.
+// Memory gets accounted per phase as well, see memstats.h
+
+#ifndef progress_h
+#define progress_h
+
+#include <atomic>
+#include <cstddef>
+#include <functional>
+#include <stdexcept>
+#include <string>
+
+// How often (at most) the callback is called per phase
+#define PROGRESS_STEPS 1000
+
+// Arguments: the name of the phase, work done so far, total work
+using ProgressFn = std::function<void(const std::string&, size_t, size_t)>;
+
+// Thrown out of a calculation that got cancelled
+struct Cancelled : public std::runtime_error {
+    Cancelled() : std::runtime_error("Cancelled") {}
+};
+
+// Wraps fn (which may be empty) in a callback that throws Cancelled
+// once cancel is set. Returns fn itself if there is no cancel flag
+ProgressFn cancellable(ProgressFn fn, const std::atomic<bool>* cancel);
+
+
+class Progress {
+    public:
+        Progress(const ProgressFn& fn, std::string phase, size_t total);
+
+        void inc(const size_t val);
+        void inc();
+
+    private:
+        // Calls the callback if there is one
+        void report();
+
+        const ProgressFn fn;
+        const std::string phase;
+        const size_t total;
+        size_t cur;
+        // Next value of cur at which we report
+        size_t next;
+};
+
+#endif
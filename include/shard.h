@@ -0,0 +1,43 @@
+// A ShardJob is one slice of the guesses of a round, which can be worked
+// out on its own: in another process, or on another machine. The output
+// of a shard is plain text, so it can be passed around through pipes or
+// sockets, and kept on disk so finished shards never have to be redone
+
+#ifndef shard_h
+#define shard_h
+
+#include "evaltree.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+
+struct ShardJob {
+    std::string dictionary;
+    size_t wlen;
+    // This is shard index (counting from 0) of count
+    size_t index;
+    size_t count;
+    // The guesses made so far, alternating word and marks
+    std::vector<std::string> played;
+
+    // To and from the arguments of the `shard` subcommand:
+    // dictionary wlen index count [word marks ...]
+    std::vector<std::string> to_args() const;
+    static ShardJob from_args(const std::vector<std::string>& args);
+};
+
+
+// Works out the accumulators of all guesses in the shard and writes
+// them to out (see write_accumulators)
+void run_shard(const ShardJob& job, std::ostream& out);
+
+// Runs shards for anyone that connects on host:port. A client sends the
+// arguments of a job on one line, and gets the output of run_shard back
+void serve_shards(const std::string& host, uint16_t port);
+
+#endif
@@ -3,7 +3,14 @@
 
 #include <algorithm>
 #include<lguess.h>
+#include "dictionary.h"
+#include "evaltree.h"
+#include "memstats.h"
+#include "progress.h"
+#include "wordset.h"
 
+#include <atomic>
+#include <chrono>
 #include <string>
 #include <vector>
 #include <memory>
@@ -12,11 +19,113 @@
 #include <queue>
 #include <functional>
 
+// Number of suggestions calculate_best_guess returns by default
+#define SUGGESTION_C 10
+// Default seconds between two checkpoints
+#define CHECKPOINT_INTERVAL 30
+// Guesses that are worked out together between two checkpoints
+#define CHECKPOINT_CHUNK 256
 
-// Collection of letter guesses
+// Results of earlier calculations that are kept around by default
+#define RESULT_CACHE_C 16
+// Feedback patterns that get worked out ahead of time by speculate
+#define SPECULATE_C 3
+// Guesses in the first chunk of a calculation with a deadline. Every 
+// next chunk is twice as big, so checking the clock costs little
+#define DEADLINE_CHUNK 32
+
+// Ways to score the guesses, see evaltree.h and histengine.h
+#define ENGINE_TREE 0
+#define ENGINE_HIST 1
+
+
+// Knobs for calculate_best_guess
+struct SolveOptions {
+    // Amount of ranked guesses to return
+    size_t top_n = SUGGESTION_C;
+    // Gets called (on the calling thread) as the calculation progresses
+    ProgressFn progress;
+    // If set, the guesses that are done get saved in this file every
+    // checkpoint_interval seconds. A calculation of the same round, 
+    // with the same engine, picks them up from there and only does the rest
+    std::string checkpoint;
+    double checkpoint_interval = CHECKPOINT_INTERVAL;
+    // Guesses and answers that get scored together, 0 picks them
+    // from the cache sizes of the machine
+    Tiling tiling;
+    // Most bytes the calculation may use (0 for no limit). If a single
+    // tree would not fit, the guesses get worked out in chunks that do
+    size_t memory_limit = 0;
+    // ENGINE_TREE or ENGINE_HIST. Words that are too long to pack their
+    // feedback always use the tree
+    int engine = ENGINE_TREE;
+    // Threads the histogram engine uses, 0 for all cores
+    size_t threads = 0;
+    // If set, the calculation stops as soon as it can once this becomes
+    // true, and calculate_best_guess throws Cancelled
+    const std::atomic<bool>* cancel = nullptr;
+    // Account for the memory the calculation uses, see memstats.h
+    bool memory_stats = false;
+    // If not 0, only this many guesses get scored exactly: the ones the
+    // heuristic (see heuristic.h) likes best. The remaining words get 
+    // scored as well, when there are no more of them than this
+    size_t shortlist = 0;
+    // Also scores all guesses, to see if the best one made the shortlist
+    bool audit_shortlist = false;
+    // If not 0, returns the best guesses found after about this many 
+    // seconds. The guesses get scored in chunks, the ones the heuristic
+    // likes best first, and the chunk that is cut short by the deadline
+    // does not count. The first chunk always gets done, so there is
+    // something to suggest. Does not use the checkpoint
+    double deadline = 0;
+};
+
+// Whether the shortlist held the best guess
+struct ShortlistAudit {
+    // False if there was no shortlist to audit
+    bool done = false;
+    // The best of all guesses, and its place in the heuristic ranking
+    // (0 is first). It missed the shortlist if that is past its end
+    std::string best;
+    double score = 0;
+    size_t rank = 0;
+    bool missed = false;
+};
+
+// Everything calculate_best_guess found out
+struct SolveResult {
+    // The best guesses, best first
+    std::vector<Suggestion> guesses;
+    // All words still in the running, and their score as a guess
+    std::vector<Suggestion> candidates;
+    // How long the calculation took, in seconds
+    double seconds;
+    // Only filled in if SolveOptions::memory_stats was set (and the
+    // result was not cached)
+    MemoryReport memory;
+    // Only filled in if SolveOptions::audit_shortlist was set
+    ShortlistAudit audit;
+    // True if the deadline hit before all guesses got scored. The scores
+    // are exact, but only scored of all guesses were looked at. Partial
+    // results are not cached
+    bool partial = false;
+    size_t scored = 0;
+};
+
+
+class ResultCache;
+
+
+// Collection of letter guesses. Does not write to the console, and
+// any number of them can be used concurrently on a shared Dictionary.
+// Words go in and come out as UTF-8, see include/alphabet.h
 class WordleSolver {
     public:
         WordleSolver(std::string filename, size_t wlen);
+        WordleSolver(std::shared_ptr<const Dictionary> d);
+        // Copies the game of s as it is now (the words left and the letters
+        // guessed), sharing its dictionary and cache
+        WordleSolver(const WordleSolver& s);
 
         // Update the words_left with the new information
         void update(const std::string& word, const std::string& marks);
@@ -24,23 +133,99 @@ class WordleSolver {
         // Returns true when:
         // - There are no words left in words_left (word not in dict)
         // - There is one word left in words_left (that must be it)
-        // And prints some info about this to the console
         bool done() const;
 
-        // Does what it says on the tin
-        void calculate_best_guess() const;
+        // Does what it says on the tin. Results are cached per round
+        SolveResult calculate_best_guess(const SolveOptions& opts = {}) const;
+
+        // Keeps results in c from now on (instead of a cache of its own).
+        // Games started from this one share it as well
+        void share_cache(std::shared_ptr<ResultCache> c) { cache = c; }
+
+        // Uses idle time: works out (and caches) the next round for the
+        // n most likely feedbacks on the best guess of res, the biggest
+        // buckets first. Stops early when opts.cancel gets set
+        void speculate(
+            const SolveResult& res, const SolveOptions& opts, 
+            size_t n = SPECULATE_C
+        ) const;
+
+        // Works out how many words are left after each guess in shard
+        // index (counting from 0) of count equal slices of the dictionary
+        std::map<std::string, Accumulator> accumulate(
+            size_t index, size_t count, const ProgressFn& progress = nullptr
+        ) const;
+
+        // The words that still fit all guesses so far
+        std::vector<std::string> remaining() const;
+        // How many there are of them
+        size_t remaining_c() const { return words_left->size(); }
+
+        // True if no information has been entered yet
+        bool first_round() const;
+
+        // The letters we know the position of so far
+        std::string known() const;
+
+        size_t length() const { return wlen; }
 
     private:
-        // Reads in a dictionary file
-        void read_dict(std::string filename, size_t wlen);
-        // Stores the original full dictionary
-        std::unique_ptr<std::list<std::string>> dict;
-        // Stores all the words that are compatible with previous guesses
-        std::unique_ptr<std::list<std::string>> words_left;
+        // Calculates in chunks of this many guesses, see 
+        // SolveOptions::checkpoint and SolveOptions::memory_limit
+        SolveResult chunked(
+            const SolveOptions& opts, size_t chunk,
+            const std::list<std::string>& guesses
+        ) const;
+        // Scores guesses in the order of ranked until opts.deadline 
+        // seconds after start, see SolveOptions::deadline
+        SolveResult anytime(
+            const SolveOptions& opts,
+            const std::vector<const std::string*>& ranked,
+            std::chrono::steady_clock::time_point start
+        ) const;
+        // Adds how many words are left after each guess of chunk to done
+        void score_chunk(
+            const SolveOptions& opts, const std::list<std::string>& chunk,
+            const ProgressFn& progress,
+            std::map<std::string, Accumulator>& done
+        ) const;
+        // Scores all guesses, to see how the shortlist of a round did
+        ShortlistAudit audit(
+            const SolveOptions& opts,
+            const std::vector<const std::string*>& ranked,
+            const std::list<std::string>& shortlist
+        ) const;
+        // How many guesses to put in one tree
+        size_t chunk_size(const SolveOptions& opts) const;
+        // True if opts asks for histograms, and they work for wlen
+        bool histograms(const SolveOptions& opts) const;
+        // Identifies the current round
+        std::string round_key() const;
+        // Identifies the scores of a calculation with opts this round
+        std::string checkpoint_key(const SolveOptions& opts) const;
+        // Fingerprint of the result of a calculation with opts this round
+        std::string cache_key(const SolveOptions& opts) const;
+
+        // The words and their indexes, possibly memory mapped
+        std::shared_ptr<const Dictionary> dictionary;
+        // Stores the original full dictionary (shared between games).
+        // This and the rest below hold words in their inner form
+        std::shared_ptr<const std::list<std::string>> dict;
+        // Stores all the words that are compatible with previous guesses.
+        // Only gets replaced, never changed, so games can share it
+        std::shared_ptr<const std::list<std::string>> words_left;
+        // The same words, as indices into the dictionary
+        WordSet left;
+        // Of all words in dict, worked out once
+        uint64_t dict_hash;
         // Stores all the characters already guessed correctly
         std::string guessed;
         // The length of the words
         const size_t wlen;
+        // Picked once, from wlen
+        const Kernels kern;
+        // Recent results, shared between games
+        std::shared_ptr<ResultCache> cache;
 };
 
 #endif
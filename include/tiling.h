@@ -0,0 +1,28 @@
+// Scoring every guess against every remaining word streams the whole 
+// list of remaining words through the cache once per guess. Instead we 
+// work in tiles: a block of guesses against a block of answers, where
+// the answers fit in L1 and the histograms of the guesses fit in L2
+
+#ifndef tiling_h
+#define tiling_h
+
+#include <cstddef>
+
+// Used when the cache sizes cannot be found out
+#define TILE_L1_DEFAULT (32 * 1024)
+#define TILE_L2_DEFAULT (1024 * 1024)
+// Most guesses in a block, more does not help once the answers are hot
+#define TILE_MAX_GUESSES 64
+
+
+// The size of a tile. A 0 means: work it out from the cache sizes
+struct Tiling {
+    size_t guesses = 0;
+    size_t answers = 0;
+};
+
+// Fills in the sizes that are 0 in t, for words of length wlen and 
+// histograms that take hist_bytes each
+Tiling auto_tiling(Tiling t, size_t wlen, size_t hist_bytes);
+
+#endif
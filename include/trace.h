@@ -0,0 +1,45 @@
+// Opt-in timeline of what the solver spends its time on, in the Chrome
+// trace event format (open it in chrome://tracing or ui.perfetto.dev).
+// Code marks its steps with a TraceSpan. Once start_trace has been
+// called, every span that ends is written to the file as a complete
+// event, on the thread it ran on. Until then, a span only does a single
+// check. Spans are meant for steps of at least some microseconds, not
+// for the inner loops
+//
+// The file gets flushed whenever the outermost span of a thread ends,
+// so a trace of a process that got killed is still readable
+
+#ifndef trace_h
+#define trace_h
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+
+// Writes all spans from now on to filename, until stop_trace.
+// Throws if the file cannot be opened
+void start_trace(const std::string& filename);
+
+// Finishes the trace file. Also happens at exit
+void stop_trace();
+
+
+class TraceSpan {
+    public:
+        // name should outlive the span (a literal, usually). work is
+        // shown with the span if it is not 0, e.g. the amount of words
+        TraceSpan(const char* name, size_t work = 0);
+        ~TraceSpan();
+
+        TraceSpan(const TraceSpan&) = delete;
+        TraceSpan& operator=(const TraceSpan&) = delete;
+
+    private:
+        const char* name;
+        const size_t work;
+        // Microseconds since the trace started, or -1 if not tracing
+        int64_t start;
+};
+
+#endif
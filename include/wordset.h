@@ -0,0 +1,135 @@
+// A WordSet is a set of word indices (into a Dictionary), kept the way
+// Roaring bitmaps keep them. The indices are split into blocks by their
+// upper 16 bits, and each block is stored in whichever form is smallest
+// for it: a sorted array of the lower 16 bits when it is sparse, a
+// bitmap when it is dense, or runs of consecutive indices (all words of
+// a dictionary are a single run per block).
+//
+// Intersecting only looks at the blocks both sets have, and then walks
+// the smaller side, so it takes time in the order of the smaller set
+// instead of the size of the dictionary
+
+#ifndef wordset_h
+#define wordset_h
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <utility>
+#include <vector>
+
+// Indices per block
+#define WORDSET_BLOCK (1 << 16)
+// Most indices a block keeps in an array, beyond that a bitmap is smaller
+#define WORDSET_ARRAY_MAX 4096
+
+// The forms a block can take
+#define WORDSET_ARRAY 0
+#define WORDSET_BITMAP 1
+#define WORDSET_RUNS 2
+
+
+class WordSet {
+    public:
+        WordSet() = default;
+        // The indices in sorted, which has to be in ascending order
+        explicit WordSet(std::span<const uint32_t> sorted);
+        // All indices below n
+        static WordSet all(size_t n);
+
+        size_t size() const { return count; }
+        bool empty() const { return count == 0; }
+        bool contains(uint32_t i) const;
+
+        // Only keeps the indices that are in other as well
+        WordSet& operator&=(const WordSet& other);
+
+        // Only keeps the indices keep(i) returns true for
+        template<class F> void filter(F keep);
+
+        // Calls fn(i) for every index, in ascending order
+        template<class F> void for_each(F fn) const;
+
+    private:
+        struct Block {
+            uint16_t key;     // upper 16 bits of all indices in here
+            int form;         // WORDSET_*
+            uint32_t count;   // indices in the block
+
+            // Only the one of the form is used
+            std::vector<uint16_t> array;
+            std::vector<uint64_t> bits;
+            // First and last (not one past) of each run
+            std::vector<std::pair<uint16_t, uint16_t>> runs;
+
+            bool contains(uint16_t low) const;
+            template<class F> void for_each(F fn) const;
+
+            // Picks the smallest form for what is in the block now
+            void settle();
+        };
+
+        // The indices of both, in the smallest form
+        static Block intersect(const Block& a, const Block& b);
+        // A block of (sorted) lower halves
+        static Block from_array(uint16_t key, std::vector<uint16_t> low);
+
+        // Ordered by key, and none of them empty
+        std::vector<Block> blocks;
+        size_t count = 0;
+};
+
+
+template<class F>
+void WordSet::Block::for_each(F fn) const {
+    switch(form) {
+        case WORDSET_ARRAY:
+            for(auto low : array) fn(low);
+            break;
+
+        case WORDSET_BITMAP:
+            for(size_t w = 0; w < bits.size(); w++) {
+                for(uint64_t b = bits[w]; b; b &= b - 1) {
+                    fn(uint16_t(w * 64 + std::countr_zero(b)));
+                }
+            }
+            break;
+
+        case WORDSET_RUNS:
+            for(auto [first, last] : runs) {
+                for(uint32_t low = first; low <= last; low++) fn(uint16_t(low));
+            }
+            break;
+    }
+}
+
+
+template<class F>
+void WordSet::for_each(F fn) const {
+    for(auto &b : blocks) {
+        const uint32_t base = uint32_t(b.key) << 16;
+        b.for_each([&](uint16_t low) { fn(base | low); });
+    }
+}
+
+
+template<class F>
+void WordSet::filter(F keep) {
+    std::vector<Block> kept;
+    count = 0;
+
+    for(auto &b : blocks) {
+        const uint32_t base = uint32_t(b.key) << 16;
+        std::vector<uint16_t> low;
+        b.for_each([&](uint16_t l) { if(keep(base | l)) low.push_back(l); });
+        if(low.empty()) continue;
+
+        kept.push_back(from_array(b.key, std::move(low)));
+        count += kept.back().count;
+    }
+
+    blocks = std::move(kept);
+}
+
+#endif
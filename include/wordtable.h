@@ -0,0 +1,46 @@
+// A WordTable holds a list of words back to back, together with the
+// letter counts and the letter mask of every word (like the Dictionary
+// does). Filters refer to the words by their index in the table, and
+// check how often a letter occurs with a lookup instead of a scan
+
+#ifndef wordtable_h
+#define wordtable_h
+
+#include "dictionary.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+
+class WordTable {
+    public:
+        WordTable(const std::list<std::string>& words, size_t wlen);
+
+        size_t size() const { return masks.size(); }
+
+        const char* word(size_t i) const { return &words[i * wlen]; }
+
+        // How often each letter of the alphabet occurs in word i
+        const uint8_t* counts(size_t i) const {
+            return &letter_c[i * letters];
+        }
+
+        // Bit n is set if the n'th letter of the alphabet is in word i
+        lmask_t mask(size_t i) const { return masks[i]; }
+
+        // The indices of all words, in order
+        std::vector<uint32_t> all() const;
+
+    private:
+        const size_t wlen;
+        // Entries per word in letter_c: up to the last letter used
+        size_t letters;
+        std::string words;
+        std::vector<uint8_t> letter_c;
+        std::vector<lmask_t> masks;
+};
+
+#endif
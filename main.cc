@@ -1,11 +1,80 @@
 #include "solver.h"
+#include "dictionary.h"
+#include "daemon.h"
+#include "multisolver.h"
+#include "coordinator.h"
+#include "cache.h"
+#include "trace.h"
+#include "bar.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstddef>
+#include <iomanip>
 #include <iostream>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <sstream>
+#include <thread>
+#include <unistd.h>
 #include <argparse.h>
 
 #define DEFAULT_LENGTH 5
+// When there are fewer words left than this 
+// number we start listing them out
+#define SHOW_LEFT_C 8
+// Column width for suggestion table
+#define COL_W 15
+// Column width for the names of phases in the memory table
+#define PHASE_COL_W 40
+
+// Arguments for keeping results around, see include/cache.h
+void add_cache_arguments(argparse::ArgumentParser& program) {
+    program.add_argument("--cache")
+        .help("Keep results in this file, and reuse them from there")
+        .default_value(std::string());
+
+    program.add_argument("--cache-size")
+        .help("Results to keep in memory")
+        .default_value(RESULT_CACHE_C)
+        .scan<'d', int>();
+}
+
+
+// The cache the arguments ask for, or none for the default
+std::shared_ptr<ResultCache> make_cache(argparse::ArgumentParser& args) {
+    std::string file = args.get<std::string>("--cache");
+    int size = args.get<int>("--cache-size");
+    if(file.empty() && size == RESULT_CACHE_C) return nullptr;
+
+    return std::make_shared<ResultCache>(std::max(0, size), file);
+}
+
+
+// Writes a timeline of the calculations, see include/trace.h
+void add_trace_argument(argparse::ArgumentParser& program) {
+    program.add_argument("--trace")
+        .help("Write a Chrome trace of the calculations to this file")
+        .default_value(std::string());
+}
+
+
+// Bounds how long a round may take, see SolveOptions::deadline
+void add_deadline_argument(argparse::ArgumentParser& program) {
+    program.add_argument("--deadline")
+        .help("Suggest the best guesses found after this many seconds")
+        .default_value(0.0)
+        .scan<'g', double>();
+}
+
+
+// Starts the trace the arguments ask for, if any
+void start_trace(argparse::ArgumentParser& args) {
+    std::string file = args.get<std::string>("--trace");
+    if(!file.empty()) start_trace(file);
+}
+
 
 // Specifies the arguments using the include/argparse.h header
 // on github @ https://github.com/p-ranav/argparse
@@ -16,7 +85,7 @@ argparse::ArgumentParser arg_spec() {
     );
 
     program.add_argument("dictionary")
-        .help("The dictionary to use when guessing");
+        .help("The (text or compiled) dictionary to use when guessing");
 
     program.add_argument("-l", "--wordlength")
         .help("Only words of this length will be used")
@@ -28,11 +97,577 @@ argparse::ArgumentParser arg_spec() {
         .default_value(false)
         .implicit_value(true);
 
+    program.add_argument("--checkpoint")
+        .help("Save progress in this file, and resume from it")
+        .default_value(std::string());
+
+    program.add_argument("--checkpoint-interval")
+        .help("Seconds between two checkpoints")
+        .default_value(double(CHECKPOINT_INTERVAL))
+        .scan<'g', double>();
+
+    program.add_argument("-b", "--boards")
+        .help("Play this many boards at once (Quordle, Octordle, ...)")
+        .default_value(1)
+        .scan<'d', int>();
+
+    program.add_argument("--memory-limit")
+        .help("Megabytes the calculation may use (0 for no limit)")
+        .default_value(0)
+        .scan<'d', int>();
+
+    program.add_argument("--memory-stats")
+        .help("Show how much memory each phase and part of a round uses")
+        .default_value(false)
+        .implicit_value(true);
+
+    add_cache_arguments(program);
+    add_trace_argument(program);
+    add_deadline_argument(program);
+
+    program.add_argument("--shortlist")
+        .help("Only score this many guesses exactly, picked by a heuristic")
+        .default_value(0)
+        .scan<'d', int>();
+
+    program.add_argument("--audit-shortlist")
+        .help("Also score all guesses, and show if the best made the shortlist")
+        .default_value(false)
+        .implicit_value(true);
+
+    program.add_argument("-e", "--engine")
+        .help("How to score guesses: tree, or hist (faster, exact buckets)")
+        .default_value(std::string("tree"));
+
+    program.add_argument("-j", "--threads")
+        .help("Threads for the hist engine (0 uses all cores)")
+        .default_value(0)
+        .scan<'d', int>();
+
+    program.add_argument("--tile-guesses")
+        .help("Guesses scored together (0 picks it from the cache size)")
+        .default_value(0)
+        .scan<'d', int>();
+
+    program.add_argument("--tile-answers")
+        .help("Answers scored together (0 picks it from the cache size)")
+        .default_value(0)
+        .scan<'d', int>();
+
+    return program;
+}
+
+
+// Arguments for the `compile` subcommand
+argparse::ArgumentParser compile_spec() {
+    argparse::ArgumentParser program(
+        "brutefordle compile", "dev",
+        argparse::default_arguments::help
+    );
+
+    program.add_argument("dictionary")
+        .help("The text dictionary to compile");
+
+    program.add_argument("output")
+        .help("Where to write the compiled dictionary");
+
+    return program;
+}
+
+
+// Writes a binary dictionary that can be used in place of the text one
+int compile(int argc, char** argv) {
+    auto argparser = compile_spec();
+
+    try{ argparser.parse_args(argc, argv); }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl << argparser;
+        std::exit(1);
+    }
+
+    try {
+        Dictionary::compile(
+            argparser.get<std::string>("dictionary"),
+            argparser.get<std::string>("output")
+        );
+    }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Arguments for the `daemon` subcommand
+argparse::ArgumentParser daemon_spec() {
+    argparse::ArgumentParser program(
+        "brutefordle daemon", "dev",
+        argparse::default_arguments::help
+    );
+
+    program.add_argument("dictionary")
+        .help("The (text or compiled) dictionary to use when guessing");
+
+    program.add_argument("socket")
+        .help("Path of the Unix domain socket to listen on");
+
+    program.add_argument("-l", "--wordlength")
+        .help("Word length of games that do not specify one")
+        .default_value(DEFAULT_LENGTH)
+        .scan<'d', int>();
+
+    add_cache_arguments(program);
+    add_trace_argument(program);
+    add_deadline_argument(program);
+    return program;
+}
+
+
+// Serves games over a Unix domain socket, see include/daemon.h
+int serve(int argc, char** argv) {
+    auto argparser = daemon_spec();
+
+    try{ argparser.parse_args(argc, argv); }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl << argparser;
+        std::exit(1);
+    }
+
+    try {
+        start_trace(argparser);
+        SolverDaemon daemon(
+            argparser.get<std::string>("dictionary"),
+            argparser.get<int>("-l"),
+            make_cache(argparser),
+            std::max(0.0, argparser.get<double>("--deadline"))
+        );
+        std::cout 
+            << "Listening on " << argparser.get<std::string>("socket") 
+            << std::endl;
+        daemon.serve(argparser.get<std::string>("socket"));
+    }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Shows a loading bar per phase of the calculation
+ProgressFn console_progress() {
+    auto phase = std::make_shared<std::string>();
+    auto total = std::make_shared<size_t>(0);
+    auto lbar = std::make_shared<std::unique_ptr<LoadingBar>>();
+
+    // (The same phase can come again for another amount)
+    return [phase, total, lbar](const std::string& p, size_t cur, size_t max) {
+        if(p != *phase || max != *total) {
+            *phase = p;
+            *total = max;
+            std::cout << "\n" << p << "\n";
+            *lbar = std::make_unique<LoadingBar>(max);
+        }
+
+        (*lbar)->update(cur);
+    };
+}
+
+
+// A word, padded to the column width. (setw would count the
+// bytes, not the letters, of anything but plain ASCII)
+std::string column(const std::string& word) {
+    size_t letters = std::count_if(
+        word.begin(), word.end(), [](char c) { return (c & 0xc0) != 0x80; }
+    );
+    return word + std::string(COL_W - std::min<size_t>(COL_W, letters), ' ');
+}
+
+
+// Suggest the most useful guesses
+void show_guesses(const SolveResult& res) {
+    std::cout 
+        << "\n\nBEST GUESSES:\n"
+        << std::setw(COL_W) << std::left << "Guessed word" 
+        << std::setw(COL_W) << std::left << "Avg words after\n";
+    
+    for(auto &[word, score] : res.guesses) {
+        std::cout 
+            << column(word)
+            << std::setw(COL_W) << std::left << score
+            << std::endl;
+    }
+
+    std::cout << "(took " << res.seconds << " seconds)\n";
+    if(res.partial) {
+        std::cout 
+            << "(partial: only " << res.scored 
+            << " guesses got scored before the deadline)\n";
+    }
+}
+
+
+// Shows what MemoryTracker found, in megabytes
+void show_memory(const MemoryReport& mem) {
+    auto mb = [](size_t bytes) { return bytes / (double) (1 << 20); };
+
+    auto table = [&](const char* title, const std::vector<MemoryUse>& uses) {
+        std::cout 
+            << "\n" << std::setw(PHASE_COL_W) << std::left << title
+            << std::setw(COL_W) << std::left << "Allocations"
+            << std::setw(COL_W) << std::left << "MB allocated"
+            << std::setw(COL_W) << std::left << "MB peak" << "\n";
+
+        for(auto &u : uses) {
+            std::cout 
+                << std::setw(PHASE_COL_W) << std::left << u.name
+                << std::setw(COL_W) << std::left << u.allocs
+                << std::setw(COL_W) << std::left << mb(u.bytes)
+                << std::setw(COL_W) << std::left << mb(u.peak) << "\n";
+        }
+    };
+
+    std::cout << std::setprecision(4) << "\nMEMORY USE:";
+    table("Phase", mem.phases);
+    table("Part", mem.subsystems);
+    std::cout 
+        << "\nPeak resident set size: " << mb(mem.peak_rss) << " MB\n"
+        << std::setprecision(6);
+}
+
+
+// Shows whether the shortlist held the best guess. missed and
+// audits count over all rounds so far
+void show_audit(const ShortlistAudit& audit, size_t missed, size_t audits) {
+    std::cout 
+        << "\nShortlist audit: the best of all guesses is " << audit.best
+        << " (" << audit.score << "), #" << audit.rank + 1 
+        << " for the heuristic, " << (audit.missed ? "NOT " : "") 
+        << "on the shortlist\n"
+        << "Missed " << missed << " of " << audits << " rounds so far\n";
+}
+
+
+// Show the current status of the game
+void show_remaining(const WordleSolver& solver, const SolveResult& res) {
+    std::cout 
+        << "\nGuessed so far: [" << solver.known() << "]\n\n"
+        << "POSSIBLE WORDS: " << solver.remaining_c() << "\n";
+
+    if(solver.remaining_c() <= SHOW_LEFT_C) {
+        std::cout
+            << std::setw(COL_W) << std::left << "Guessed word" 
+            << std::setw(COL_W) << std::left << "Avg words after\n";
+
+        for(auto &[word, score] : res.candidates) {
+            std::cout 
+                << column(word)
+                << std::setw(COL_W) << std::left << score
+                << std::endl;
+        }
+    }
+    std::cout << "\n";
+}
+
+
+// Checks if the game is over and prints something if so
+bool done(const WordleSolver& solver) {
+    if(!solver.done()) return false;
+
+    if(solver.remaining_c() == 0) {
+        std::cout << "Word not in dictionary.\n";
+    }
+    else {
+        std::cout << "The word is " << solver.remaining().front() << "\n";
+    }
+
+    return true;
+}
+
+
+// Arguments for the `shard` subcommand
+argparse::ArgumentParser shard_spec() {
+    argparse::ArgumentParser program(
+        "brutefordle shard", "dev",
+        argparse::default_arguments::help
+    );
+
+    program.add_argument("job")
+        .help("dictionary wlen index count [word marks ...]")
+        .remaining();
+
+    return program;
+}
+
+
+// Works out a single shard and writes its output to stdout
+int shard(int argc, char** argv) {
+    auto argparser = shard_spec();
+
+    try{ 
+        argparser.parse_args(argc, argv);
+        auto args = argparser.get<std::vector<std::string>>("job");
+        run_shard(ShardJob::from_args(args), std::cout);
+    }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl << argparser;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Arguments for the `worker` subcommand
+argparse::ArgumentParser worker_spec() {
+    argparse::ArgumentParser program(
+        "brutefordle worker", "dev",
+        argparse::default_arguments::help
+    );
+
+    program.add_argument("port")
+        .help("TCP port to listen for shards on")
+        .scan<'d', int>();
+
+    program.add_argument("--host")
+        .help("Address to listen on")
+        .default_value(std::string("127.0.0.1"));
+
+    return program;
+}
+
+
+// Works out shards for a coordinator using the tcp transport
+int worker(int argc, char** argv) {
+    auto argparser = worker_spec();
+
+    try{ 
+        argparser.parse_args(argc, argv);
+        serve_shards(
+            argparser.get<std::string>("--host"), argparser.get<int>("port")
+        );
+    }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl << argparser;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Arguments for the `distribute` subcommand
+argparse::ArgumentParser distribute_spec() {
+    argparse::ArgumentParser program(
+        "brutefordle distribute", "dev",
+        argparse::default_arguments::help
+    );
+
+    program.add_argument("dictionary")
+        .help("The dictionary, as the workers can find it");
+
+    program.add_argument("-l", "--wordlength")
+        .help("Only words of this length will be used")
+        .default_value(DEFAULT_LENGTH)
+        .scan<'d', int>();
+
+    program.add_argument("-n", "--shards")
+        .help("Amount of shards to split the guesses in")
+        .default_value(8)
+        .scan<'d', int>();
+
+    program.add_argument("-j", "--jobs")
+        .help("Amount of shards to run at the same time")
+        .default_value(4)
+        .scan<'d', int>();
+
+    program.add_argument("-w", "--work-dir")
+        .help("Where finished shards are kept, for restarts")
+        .default_value(std::string("shards"));
+
+    program.add_argument("-c", "--command")
+        .help("Command(s) that run this program, e.g. \"ssh host brutefordle\"")
+        .default_value(std::vector<std::string>())
+        .append();
+
+    program.add_argument("-t", "--tcp")
+        .help("Worker(s) to send shards to, as host:port")
+        .default_value(std::vector<std::string>())
+        .append();
+
+    program.add_argument("-p", "--played")
+        .help("Guesses made so far: word marks [word marks ...]")
+        .default_value(std::vector<std::string>())
+        .remaining();
+
     return program;
 }
 
 
+// Runs the first round (or any other) as shards on other processes
+int distribute(int argc, char** argv) {
+    auto argparser = distribute_spec();
+
+    try{ argparser.parse_args(argc, argv); }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl << argparser;
+        std::exit(1);
+    }
+
+    ShardJob job;
+    job.dictionary = argparser.get<std::string>("dictionary");
+    job.wlen = argparser.get<int>("-l");
+    job.played = argparser.get<std::vector<std::string>>("--played");
+
+    std::vector<std::unique_ptr<Transport>> transports;
+
+    for(auto &c : argparser.get<std::vector<std::string>>("--command")) {
+        std::istringstream words(c);
+        std::vector<std::string> command;
+        for(std::string w; words >> w; ) command.push_back(w);
+        transports.push_back(std::make_unique<PipeTransport>(command));
+    }
+
+    for(auto &w : argparser.get<std::vector<std::string>>("--tcp")) {
+        size_t colon = w.rfind(':');
+        if(colon == std::string::npos) {
+            std::cerr << "Expected host:port, got " << w << std::endl;
+            return 1;
+        }
+
+        transports.push_back(std::make_unique<TcpTransport>(
+            w.substr(0, colon), std::stoi(w.substr(colon + 1))
+        ));
+    }
+
+    // By default, run the shards as child processes of this executable
+    if(transports.empty()) {
+        char self[4096];
+        ssize_t n = readlink("/proc/self/exe", self, sizeof(self) - 1);
+        std::string exe = n > 0 ? std::string(self, n) : "brutefordle";
+        transports.push_back(std::make_unique<PipeTransport>(
+            std::vector<std::string>{exe}
+        ));
+    }
+
+    try {
+        Coordinator coordinator(
+            job, argparser.get<int>("-n"), std::move(transports),
+            argparser.get<std::string>("-w")
+        );
+
+        show_guesses(coordinator.run(
+            std::max(0, argparser.get<int>("-j")), SUGGESTION_C,
+            console_progress()
+        ));
+    }
+
+    catch (const std::exception& err) {
+        std::cerr << "\n" << err.what() << std::endl;
+        return 1;
+    }
+
+    return 0;
+}
+
+
+// Game loop for playing several boards at once
+int play_boards(const std::string& dict_name, int wlen, int boards, bool suggest) {
+    MultiSolver solver(Dictionary::load(dict_name, wlen), boards);
+
+    std::string word;
+    std::vector<std::string> marks(boards);
+
+    while(!solver.done()) {
+        if(suggest) {
+            auto res = solver.calculate_best_guess({ 
+                .progress = console_progress() 
+            });
+            show_guesses(res);
+        }
+
+        std::cout << "\n";
+        for(size_t b = 0; b < solver.boards(); b++) {
+            auto left = solver.remaining(b);
+            std::cout << "BOARD " << b + 1 << ": ";
+
+            if(solver.solved(b)) std::cout << "solved\n";
+            else if(left.empty()) std::cout << "word not in dictionary\n";
+            else if(left.size() == 1) std::cout << "the word is " << left[0] << "\n";
+            else {
+                std::cout << left.size() << " possible words";
+                if(left.size() <= SHOW_LEFT_C) {
+                    for(auto &w : left) std::cout << " " << w;
+                }
+                std::cout << "\n";
+            }
+        }
+
+        // Await user input
+        std::cout 
+            << "\nEnter the results for a word:\n"
+            << "FORMAT: word marks_1 ... marks_" << boards << "\n"
+            << "Where marks is a sequence of:\n"
+            << "    v if in the correct spot\n"
+            << "    c if in the word\n"
+            << "    x if not in the word\n"
+            << "Marks for solved boards are ignored.\n\n"
+            << "Or use '!q' to quit the program.\n";
+        
+        std::cin >> word;
+        if(word == "!q") { break; }
+        for(auto &m : marks) std::cin >> m;
+        
+        try { solver.update(word, marks); } 
+
+        catch (std::runtime_error& e) {
+            std::cout 
+                << "Something went wrong processing guess: " 
+                << e.what() << "\n";
+
+            suggest = false;
+            continue;
+        }
+
+        suggest = true;
+    }
+
+    return 0;
+}
+
+
 int main(int argc, char** argv) {
+    // Subcommands get the arguments after their name
+    if(argc > 1 && std::string(argv[1]) == "compile") {
+        return compile(argc - 1, argv + 1);
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "daemon") {
+        return serve(argc - 1, argv + 1);
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "shard") {
+        return shard(argc - 1, argv + 1);
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "worker") {
+        return worker(argc - 1, argv + 1);
+    }
+
+    if(argc > 1 && std::string(argv[1]) == "distribute") {
+        return distribute(argc - 1, argv + 1);
+    }
+
     auto argparser = arg_spec();
 
     try{ argparser.parse_args(argc, argv); }
@@ -46,32 +681,177 @@ int main(int argc, char** argv) {
     std::string dict_name = argparser.get<std::string>("dictionary");
     int wlen = argparser.get<int>("-l");
     bool suggest = !argparser.get<bool>("-s");
+    int boards = argparser.get<int>("-b");
+    std::string checkpoint = argparser.get<std::string>("--checkpoint");
+    double interval = argparser.get<double>("--checkpoint-interval");
+    Tiling tiling = {
+        (size_t) std::max(0, argparser.get<int>("--tile-guesses")),
+        (size_t) std::max(0, argparser.get<int>("--tile-answers"))
+    };
+    size_t memory_limit = 
+        (size_t) std::max(0, argparser.get<int>("--memory-limit")) << 20;
+    std::string engine = argparser.get<std::string>("-e");
+    size_t threads = std::max(0, argparser.get<int>("-j"));
+    bool memory_stats = argparser.get<bool>("--memory-stats");
+    size_t shortlist = std::max(0, argparser.get<int>("--shortlist"));
+    bool audit_shortlist = argparser.get<bool>("--audit-shortlist");
+    double deadline = std::max(0.0, argparser.get<double>("--deadline"));
+
+    if(wlen <= 0 || wlen > MAX_WORD_LENGTH) {
+        std::cerr << "Word length has to be 1 to " << MAX_WORD_LENGTH << std::endl;
+        std::exit(1);
+    }
+
+    if(engine != "tree" && engine != "hist") {
+        std::cerr << "Unknown engine: " << engine << std::endl;
+        std::exit(1);
+    }
+
+    try { start_trace(argparser); }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+
+    if(boards > 1) {
+        // The boards are scored in a single pass of their own, which
+        // none of the options of the single board solver apply to
+        for(auto option : {
+            "--checkpoint", "--checkpoint-interval", "--memory-limit",
+            "--memory-stats", "--shortlist", "--audit-shortlist", "-e", "-j",
+            "--tile-guesses", "--tile-answers", "--cache", "--cache-size",
+            "--deadline"
+        }) {
+            if(argparser.is_used(option)) {
+                std::cerr << option << " can not be used with -b" << std::endl;
+                return 1;
+            }
+        }
+
+        try { return play_boards(dict_name, wlen, boards, suggest); }
+
+        catch (const std::runtime_error& err) {
+            std::cerr << err.what() << std::endl;
+            return 1;
+        }
+    }
     
     // The main solver
     WordleSolver solver(dict_name, wlen);
 
+    try { if(auto cache = make_cache(argparser)) solver.share_cache(cache); }
+
+    catch (const std::runtime_error& err) {
+        std::cerr << err.what() << std::endl;
+        return 1;
+    }
+
     // Hold input strings
     std::string word;
     std::string marks;
+
+    // On a terminal, suggestions get worked out in the background while
+    // the prompt already takes the next guess, which cancels them
+    const bool background = isatty(STDIN_FILENO);
+    std::atomic<bool> cancel = false;
+    std::atomic<bool> shown = false;
+    std::mutex console;
+    std::thread suggester;
+    // Rounds the shortlist got audited in, and missed the best guess
+    size_t audits = 0, missed = 0;
+
+    auto stop_suggester = [&]() {
+        cancel = true;
+        if(suggester.joinable()) suggester.join();
+        cancel = false;
+    };
     
-    while(!solver.done()) {
-        if(suggest) solver.calculate_best_guess();
+    while(!done(solver)) {
+        if(suggest) {
+            SolveOptions opts = {
+                .progress = background ? nullptr : console_progress(),
+                .checkpoint = checkpoint,
+                .checkpoint_interval = interval,
+                .tiling = tiling,
+                .memory_limit = memory_limit,
+                .engine = engine == "hist" ? ENGINE_HIST : ENGINE_TREE,
+                .threads = threads,
+                .cancel = background ? &cancel : nullptr,
+                .memory_stats = memory_stats,
+                .shortlist = shortlist,
+                .audit_shortlist = audit_shortlist,
+                .deadline = deadline
+            };
+
+            shown = false;
+            auto suggestions = [
+                &solver, &console, &shown, &audits, &missed, opts
+            ]() {
+                SolveResult res = solver.calculate_best_guess(opts);
+
+                {
+                    std::lock_guard<std::mutex> guard(console);
+                    show_guesses(res);
+                    if(!res.memory.phases.empty()) show_memory(res.memory);
+                    if(res.audit.done) {
+                        audits++;
+                        missed += res.audit.missed;
+                        show_audit(res.audit, missed, audits);
+                    }
+                    show_remaining(solver, res);
+                    shown = true;
+                }
+
+                // While waiting for the marks, get the likely next rounds
+                // ready (gets cancelled along with the rest)
+                if(opts.cancel) solver.speculate(res, opts);
+            };
+
+            if(background) {
+                std::cout << "\nWorking out suggestions...\n";
+
+                suggester = std::thread([suggestions, &console]() {
+                    try { suggestions(); }
+                    catch (const Cancelled&) {}
+                    catch (const std::runtime_error& err) {
+                        std::lock_guard<std::mutex> guard(console);
+                        std::cerr << err.what() << std::endl;
+                    }
+                });
+            }
+
+            else {
+                try { suggestions(); }
+
+                catch (const std::runtime_error& err) {
+                    std::cerr << err.what() << std::endl;
+                    return 1;
+                }
+            }
+        }
 
         // Await user input
-        std::cout 
-            << "\nEnter the results for a word:\n"
-            << "FORMAT: word {space or newline} marks\n"
-            << "Where marks is a sequence of:\n"
-            << "    v if in the correct spot\n"
-            << "    c if in the word\n"
-            << "    x if not in the word\n\n"
-            << "Or use '!q' to quit the program.\n";
+        {
+            std::lock_guard<std::mutex> guard(console);
+            std::cout 
+                << "\nEnter the results for a word:\n"
+                << "FORMAT: word {space or newline} marks\n"
+                << "Where marks is a sequence of:\n"
+                << "    v if in the correct spot\n"
+                << "    c if in the word\n"
+                << "    x if not in the word\n\n"
+                << "Or use '!q' to quit the program.\n";
+        }
         
         // Get guess
         std::cin >> word;
         if(word == "!q") { break; }
         // And its result
         std::cin >> marks;
+
+        // The suggestions are for a round that is over now
+        stop_suggester();
         
         try { solver.update(word, marks); } 
 
@@ -80,12 +860,14 @@ int main(int argc, char** argv) {
                 << "Something went wrong processing guess: " 
                 << e.what() << "\n";
 
-            suggest = false;
+            // Same round, but its suggestions may have been cancelled
+            suggest = !shown;
             continue;
         }
 
         suggest = true;
     }
 
+    stop_suggester();
     return 0;
 }
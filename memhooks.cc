@@ -0,0 +1,42 @@
+// The global operator new and delete of the command line program, which
+// report to the memory accounting (see memstats.h). They are kept out
+// of the library, so programs that embed it keep their own allocator
+
+#include "memstats.h"
+
+#include <cstdlib>
+#include <new>
+
+
+void* operator new(size_t n) {
+    void* p = std::malloc(n ? n : 1);
+    if(!p) throw std::bad_alloc();
+
+    memory_allocated(p, n);
+    return p;
+}
+
+
+void operator delete(void* p) noexcept {
+    memory_freed(p);
+    std::free(p);
+}
+
+
+void operator delete(void* p, size_t) noexcept {
+    operator delete(p);
+}
+
+
+// (Temporary buffers of e.g. std::stable_sort come from this one, and
+// go back through the ones above)
+void* operator new(size_t n, const std::nothrow_t&) noexcept {
+    void* p = std::malloc(n ? n : 1);
+    if(p) memory_allocated(p, n);
+    return p;
+}
+
+
+void operator delete(void* p, const std::nothrow_t&) noexcept {
+    operator delete(p);
+}
@@ -0,0 +1,164 @@
+#include "alphabet.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+
+namespace {
+    // Reads the code point starting at s[i] and moves i past it.
+    // Returns false on anything that is not valid UTF-8
+    bool next_code_point(std::string_view s, size_t& i, char32_t& res) {
+        const uint8_t lead = s[i++];
+        size_t extra;
+
+        if(lead < 0x80) { res = lead; return true; }
+        else if((lead & 0xe0) == 0xc0) { res = lead & 0x1f; extra = 1; }
+        else if((lead & 0xf0) == 0xe0) { res = lead & 0x0f; extra = 2; }
+        else if((lead & 0xf8) == 0xf0) { res = lead & 0x07; extra = 3; }
+        else return false;
+
+        for(size_t j = 0; j < extra; j++, i++) {
+            if(i == s.size() || (s[i] & 0xc0) != 0x80) return false;
+            res = (res << 6) | (s[i] & 0x3f);
+        }
+
+        // Overlong encodings, surrogates and anything past unicode
+        static const char32_t least[] = { 0, 0x80, 0x800, 0x10000 };
+        return res >= least[extra] && res <= 0x10ffff
+            && (res < 0xd800 || res > 0xdfff);
+    }
+
+
+    void append_utf8(std::string& s, char32_t c) {
+        if(c < 0x80) { s += (char) c; return; }
+
+        if(c < 0x800) s += (char) (0xc0 | c >> 6);
+        else {
+            if(c < 0x10000) s += (char) (0xe0 | c >> 12);
+            else {
+                s += (char) (0xf0 | c >> 18);
+                s += (char) (0x80 | ((c >> 12) & 0x3f));
+            }
+            s += (char) (0x80 | ((c >> 6) & 0x3f));
+        }
+        s += (char) (0x80 | (c & 0x3f));
+    }
+
+
+    // The lower case form of a letter, or 0 if c is not one we know.
+    // Covers ASCII, Latin-1, Latin Extended-A, Greek and Cyrillic
+    char32_t lower_letter(char32_t c) {
+        if(c >= 'a' && c <= 'z') return c;
+        if(c >= 'A' && c <= 'Z') return c + 0x20;
+
+        // Latin-1, minus × and ÷
+        if(c >= 0xc0 && c <= 0xff) {
+            if(c == 0xd7 || c == 0xf7) return 0;
+            return c <= 0xde ? c + 0x20 : c;
+        }
+
+        // Latin Extended-A: mostly pairs of upper and lower case, but
+        // the pairs shift by one in the middle, and some have no pair
+        if(c >= 0x100 && c <= 0x17f) {
+            if(c == 0x130) return 'i';
+            if(c == 0x138 || c == 0x149 || c == 0x17f) return c;
+            if(c == 0x178) return 0xff;
+
+            bool shifted = (c > 0x138 && c < 0x149) || c > 0x178;
+            return (c % 2 == 0) != shifted ? c + 1 : c;
+        }
+
+        // Greek, without the obsolete and accent-only code points
+        if(c >= 0x386 && c <= 0x3ce) {
+            if(c == 0x386) return 0x3ac;
+            if(c >= 0x388 && c <= 0x38a) return c + 0x25;
+            if(c == 0x38c) return 0x3cc;
+            if(c == 0x38e || c == 0x38f) return c + 0x3f;
+            if(c >= 0x391 && c <= 0x3ab && c != 0x3a2) return c + 0x20;
+            return c >= 0x3ac || c == 0x390 ? c : 0;
+        }
+
+        // Cyrillic
+        if(c >= 0x400 && c <= 0x45f) {
+            if(c < 0x410) return c + 0x50;
+            return c < 0x430 ? c + 0x20 : c;
+        }
+
+        return 0;
+    }
+}
+
+
+std::u32string letters_of(std::string_view word) {
+    std::u32string res;
+    char32_t c;
+
+    for(size_t i = 0; i < word.size(); ) {
+        if(!next_code_point(word, i, c) || !(c = lower_letter(c))) return {};
+        res += c;
+    }
+
+    return res;
+}
+
+
+Alphabet::Alphabet(std::u32string l) : letters(std::move(l)) {
+    std::sort(letters.begin(), letters.end());
+    letters.erase(std::unique(letters.begin(), letters.end()), letters.end());
+
+    if(letters.size() > MAX_ALPHABET_C) {
+        throw std::runtime_error(
+            "Dictionary uses " + std::to_string(letters.size())
+            + " letters, at most " + std::to_string(MAX_ALPHABET_C)
+            + " are supported"
+        );
+    }
+}
+
+
+std::string Alphabet::encode(const std::u32string& word) const {
+    std::string res(word.size(), ' ');
+
+    for(size_t i = 0; i < word.size(); i++) {
+        auto l = std::lower_bound(letters.begin(), letters.end(), word[i]);
+
+        if(l == letters.end() || *l != word[i]) {
+            std::string letter;
+            append_utf8(letter, word[i]);
+            throw std::runtime_error("Letter not in dictionary: " + letter);
+        }
+
+        res[i] = LETTER_BASE + (l - letters.begin());
+    }
+
+    return res;
+}
+
+
+std::string Alphabet::encode(std::string_view utf8) const {
+    std::u32string word = letters_of(utf8);
+    if(word.empty()) throw std::runtime_error("Word should be letters only");
+
+    return encode(word);
+}
+
+
+std::string Alphabet::decode(std::string_view word) const {
+    std::string res;
+    res.reserve(word.size());
+
+    for(auto &c : word) {
+        size_t l = letter_index(c);
+        if(l < letters.size()) append_utf8(res, letters[l]);
+        else res += c;
+    }
+
+    return res;
+}
+
+
+std::string Alphabet::utf8() const {
+    std::string res;
+    for(auto &c : letters) append_utf8(res, c);
+    return res;
+}
@@ -0,0 +1,162 @@
+#include "cache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iomanip>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+
+// The file gets rewritten when it holds this many times more
+// results than the cache does
+#define CACHE_COMPACT_FACTOR 4
+
+namespace {
+    // A result is "RESULT <guesses> <candidates> <audited>", the key on a
+    // line of its own, then one "<word> <score>" line per suggestion and,
+    // if audited is 1, "<best> <score> <rank> <missed>" for the audit
+    void write_result(
+        std::ostream& out, const std::string& key, const SolveResult& res
+    ) {
+        out << "RESULT " << res.guesses.size() << " " 
+            << res.candidates.size() << " " << res.audit.done << "\n" 
+            << key << "\n"
+            << std::setprecision(std::numeric_limits<double>::max_digits10);
+
+        for(auto &list : {&res.guesses, &res.candidates}) {
+            for(auto &[word, score] : *list) {
+                out << word << " " << score << "\n";
+            }
+        }
+
+        const ShortlistAudit &a = res.audit;
+        if(a.done) {
+            out << a.best << " " << a.score << " " << a.rank << " " 
+                << a.missed << "\n";
+        }
+        out.flush();
+    }
+
+
+    bool read_suggestions(
+        std::istream& in, size_t n, std::vector<Suggestion>& res
+    ) {
+        res.resize(n);
+        for(auto &s : res) {
+            if(!(in >> s.word >> s.score)) return false;
+        }
+
+        return true;
+    }
+
+
+    // Returns false at the end of the file, or when a result is cut off
+    bool read_result(std::istream& in, std::string& key, SolveResult& res) {
+        std::string line, tag;
+        size_t guesses, candidates;
+        // (Files from before audits were kept do not have it)
+        bool audited = false;
+
+        in >> std::ws;
+        if(!std::getline(in, line)) return false;
+        std::istringstream header(line);
+        if(!(header >> tag >> guesses >> candidates) || tag != "RESULT") {
+            return false;
+        }
+        header >> audited;
+
+        if(!std::getline(in, key)) return false;
+
+        res = {};
+        if(
+            !read_suggestions(in, guesses, res.guesses) ||
+            !read_suggestions(in, candidates, res.candidates)
+        ) {
+            return false;
+        }
+
+        ShortlistAudit &a = res.audit;
+        a.done = audited;
+        return !audited || (in >> a.best >> a.score >> a.rank >> a.missed);
+    }
+}
+
+
+ResultCache::ResultCache(size_t capacity, const std::string& filename) : 
+    capacity(capacity) 
+{
+    if(filename.empty()) return;
+
+    load(filename);
+    out.open(filename, std::ios::app);
+    if(!out) throw std::runtime_error("Could not open cache " + filename);
+}
+
+
+void ResultCache::load(const std::string& filename) {
+    std::ifstream in(filename);
+    std::string key;
+    SolveResult res;
+    size_t read = 0;
+
+    // Later results are more recent, so they end up in front
+    while(read_result(in, key, res)) {
+        insert(key, res);
+        read++;
+    }
+    in.close();
+
+    // (Without capacity nothing is kept, and the file is left alone)
+    if(capacity == 0 || read <= CACHE_COMPACT_FACTOR * capacity) return;
+
+    // Keep only what is still in the cache, oldest first
+    std::string tmp = filename + ".tmp";
+    {
+        std::ofstream compact(tmp, std::ios::trunc);
+        for(auto e = entries.rbegin(); e != entries.rend(); e++) {
+            write_result(compact, e->first, e->second);
+        }
+    }
+    std::rename(tmp.c_str(), filename.c_str());
+}
+
+
+std::optional<SolveResult> ResultCache::find(const std::string& key) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    auto e = index.find(key);
+    if(e == index.end()) return std::nullopt;
+
+    entries.splice(entries.begin(), entries, e->second);
+    return e->second->second;
+}
+
+
+void ResultCache::store(const std::string& key, const SolveResult& res) {
+    std::lock_guard<std::mutex> guard(lock);
+
+    insert(key, res);
+    if(out.is_open()) write_result(out, key, res);
+}
+
+
+void ResultCache::insert(const std::string& key, const SolveResult& res) {
+    if(capacity == 0) return;
+
+    auto e = index.find(key);
+    if(e != index.end()) {
+        e->second->second = res;
+        entries.splice(entries.begin(), entries, e->second);
+        return;
+    }
+
+    entries.emplace_front(key, res);
+    index[key] = entries.begin();
+
+    if(entries.size() > capacity) {
+        index.erase(entries.back().first);
+        entries.pop_back();
+    }
+}
@@ -0,0 +1,87 @@
+#include "checkpoint.h"
+#include "trace.h"
+
+#include <cstdio>
+#include <fstream>
+
+
+Checkpoint::Checkpoint(std::string filename, std::string key, double interval) :
+    filename(filename), key(key), interval(interval),
+    last_update(std::chrono::steady_clock::now()),
+    writer(&Checkpoint::write_loop, this)
+{}
+
+
+Checkpoint::~Checkpoint() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        stopping = true;
+    }
+
+    changed.notify_one();
+    writer.join();
+}
+
+
+std::map<std::string, Accumulator> Checkpoint::load() const {
+    std::ifstream in(filename);
+    std::string line;
+
+    if(!std::getline(in, line) || line != "CHECKPOINT " + key) return {};
+
+    try { return read_accumulators(in); }
+    catch (const std::runtime_error&) { return {}; }
+}
+
+
+void Checkpoint::update(
+    const std::map<std::string, Accumulator>& done, bool force
+) {
+    auto now = std::chrono::steady_clock::now();
+    if(!force && now - last_update < interval) return;
+    last_update = now;
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        pending = done;
+        has_pending = true;
+    }
+
+    changed.notify_one();
+}
+
+
+void Checkpoint::write_loop() {
+    std::unique_lock<std::mutex> guard(lock);
+
+    while(true) {
+        changed.wait(guard, [this]() { return has_pending || stopping; });
+        if(!has_pending) return;
+
+        auto acc = std::move(pending);
+        has_pending = false;
+
+        // Do not hold up update() while writing
+        guard.unlock();
+        write(acc);
+        guard.lock();
+    }
+}
+
+
+void Checkpoint::write(const std::map<std::string, Accumulator>& acc) const {
+    TraceSpan span("Write checkpoint", acc.size());
+
+    // Write to a temporary file first, so that the 
+    // checkpoint is always either the old or the new one
+    std::string tmp = filename + ".tmp";
+
+    {
+        std::ofstream out(tmp, std::ios::trunc);
+        out << "CHECKPOINT " << key << "\n";
+        write_accumulators(out, acc);
+        if(!out) return;
+    }
+
+    std::rename(tmp.c_str(), filename.c_str());
+}
@@ -0,0 +1,75 @@
+#include "constraint.h"
+
+#include <algorithm>
+#include <bit>
+
+
+// The tables are only read where the masks say so, and
+// get filled in when a position or letter first shows up
+Constraint::Constraint() : positions(0), present(0), counted(0) {}
+
+
+void Constraint::add(const LetterEval& e) {
+    const size_t l = letter_index(e.letter);
+    const lmask_t bit = lmask_t(1) << l;
+
+    // Only rights and places say something about their position
+    const uint64_t p = uint64_t(1) << e.idx;
+    if(e.type != LGUESS_WRONG && !(positions & p)) {
+        allowed[e.idx] = ~lmask_t(0);
+        positions |= p;
+    }
+
+    switch(e.type) {
+        case LGUESS_RIGHT:
+            allowed[e.idx] &= bit;
+            break;
+
+        // Somewhere in the word, just not here
+        case LGUESS_PLACE:
+            allowed[e.idx] &= ~bit;
+            present |= bit;
+            break;
+
+        case LGUESS_WRONG:
+            if(!(counted & bit)) {
+                max_c[l] = MAX_WORD_LENGTH;
+                counted |= bit;
+            }
+            max_c[l] = std::min<int>(
+                max_c[l], static_cast<const EvalWrong&>(e).allow
+            );
+            break;
+    }
+}
+
+
+bool Constraint::matches(
+    const char* word, const uint8_t* counts, lmask_t mask
+) const {
+    if((mask & present) != present) return false;
+
+    for(uint64_t p = positions; p; p &= p - 1) {
+        const int i = std::countr_zero(p);
+        if(!((allowed[i] >> letter_index(word[i])) & 1)) return false;
+    }
+
+    // (A letter the word does not have cannot occur too often, and 
+    // counts may not even have an entry for it)
+    for(lmask_t b = counted & mask; b; b &= b - 1) {
+        const int l = std::countr_zero(b);
+        if(counts[l] > max_c[l]) return false;
+    }
+
+    return true;
+}
+
+
+uint32_t* Constraint::partition(
+    uint32_t* first, uint32_t* last, const WordTable& t
+) const {
+    return std::partition(first, last, [&](uint32_t w) {
+        return matches(t.word(w), t.counts(w), t.mask(w));
+    });
+}
+
@@ -0,0 +1,294 @@
+#include "coordinator.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+
+namespace {
+    // Reads everything from fd until the other side is done
+    std::string read_all(int fd) {
+        std::string res;
+        char chunk[4096];
+
+        ssize_t n;
+        while((n = read(fd, chunk, sizeof(chunk))) > 0) res.append(chunk, n);
+        return res;
+    }
+
+
+    // Sends all of data, which can take more than one send. False if 
+    // the connection broke off before that
+    bool send_all(int fd, const std::string& data) {
+        for(size_t sent = 0; sent < data.size(); ) {
+            ssize_t n = send(
+                fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL
+            );
+            if(n < 0 && errno == EINTR) continue;
+            if(n <= 0) return false;
+            sent += n;
+        }
+
+        return true;
+    }
+}
+
+
+PipeTransport::PipeTransport(std::vector<std::string> command) :
+    command(command)
+{}
+
+
+std::string PipeTransport::run(const ShardJob& job) {
+    // Build the arguments before forking
+    std::vector<std::string> args = command;
+    args.push_back("shard");
+    for(auto &a : job.to_args()) args.push_back(a);
+
+    std::vector<char*> argv;
+    for(auto &a : args) argv.push_back(a.data());
+    argv.push_back(nullptr);
+
+    int fds[2];
+    if(pipe(fds) < 0) throw std::runtime_error("Could not create pipe");
+
+    pid_t pid = fork();
+    if(pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        throw std::runtime_error("Could not start worker");
+    }
+
+    if(pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        execvp(argv[0], argv.data());
+        _exit(127);
+    }
+
+    close(fds[1]);
+    std::string res = read_all(fds[0]);
+    close(fds[0]);
+
+    int status;
+    waitpid(pid, &status, 0);
+    if(!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        throw std::runtime_error("Worker failed");
+    }
+
+    return res;
+}
+
+
+TcpTransport::TcpTransport(std::string host, uint16_t port) :
+    host(host), port(port)
+{}
+
+
+std::string TcpTransport::run(const ShardJob& job) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    addrinfo* addr;
+    if(getaddrinfo(
+        host.c_str(), std::to_string(port).c_str(), &hints, &addr
+    ) != 0) {
+        throw std::runtime_error("Could not resolve " + host);
+    }
+
+    int fd = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    bool ok = fd >= 0 && connect(fd, addr->ai_addr, addr->ai_addrlen) == 0;
+    freeaddrinfo(addr);
+
+    if(!ok) {
+        if(fd >= 0) close(fd);
+        throw std::runtime_error("Could not connect to worker " + host);
+    }
+
+    std::string line;
+    for(auto &a : job.to_args()) line += a + " ";
+    line.back() = '\n';
+
+    if(!send_all(fd, line)) {
+        close(fd);
+        throw std::runtime_error("Could not send shard to worker " + host);
+    }
+
+    std::string res = read_all(fd);
+    close(fd);
+
+    return res;
+}
+
+
+Coordinator::Coordinator(
+    ShardJob job,
+    size_t shards,
+    std::vector<std::unique_ptr<Transport>> transports,
+    std::string work_dir
+) : 
+    job(job), shards(shards), 
+    transports(std::move(transports)), work_dir(work_dir)
+{
+    if(shards == 0) throw std::runtime_error("Need at least one shard");
+    if(this->transports.empty()) throw std::runtime_error("Need a transport");
+
+    std::filesystem::create_directories(work_dir);
+}
+
+
+std::string Coordinator::shard_file(size_t i) const {
+    return work_dir + "/shard-" + std::to_string(i) 
+        + "-of-" + std::to_string(shards);
+}
+
+
+std::string Coordinator::job_line() const {
+    ShardJob j = job;
+    j.index = 0;
+    j.count = shards;
+
+    std::string res = "JOB";
+    for(auto &a : j.to_args()) res += " " + a;
+    return res;
+}
+
+
+bool Coordinator::load_shard(
+    size_t i, std::map<std::string, Accumulator>& res
+) {
+    std::ifstream in(shard_file(i));
+    std::string line;
+
+    if(!std::getline(in, line) || line != job_line()) return false;
+
+    try { res = read_accumulators(in); }
+    catch (const std::runtime_error&) { return false; }
+
+    return true;
+}
+
+
+void Coordinator::finish_shard(size_t i) {
+    TraceSpan span("Run shard");
+    ShardJob j = job;
+    j.index = i;
+    j.count = shards;
+
+    for(size_t attempt = 0; attempt < SHARD_ATTEMPTS; attempt++) {
+        // Retries go to the next transport, in case this one is down
+        auto &t = transports[(i + attempt) % transports.size()];
+
+        std::string out;
+        try { out = t->run(j); }
+        catch (const std::runtime_error&) { continue; }
+
+        // Only keep output that is complete
+        std::istringstream check(out);
+        try { read_accumulators(check); }
+        catch (const std::runtime_error&) { continue; }
+
+        // Write to a temporary file first, so that a shard file 
+        // is either complete or not there at all
+        std::string tmp = shard_file(i) + ".tmp";
+        std::ofstream(tmp) << job_line() << "\n" << out;
+        std::filesystem::rename(tmp, shard_file(i));
+        return;
+    }
+
+    throw std::runtime_error("Shard " + std::to_string(i) + " failed");
+}
+
+
+SolveResult Coordinator::run(size_t jobs, size_t top_n, ProgressFn progress) {
+    // (Nothing would ever finish)
+    if(jobs == 0) throw std::runtime_error("Need at least one job");
+
+    auto start = std::chrono::steady_clock::now();
+    // Skip the shards that finished in an earlier run
+    std::vector<size_t> todo;
+    for(size_t i = 0; i < shards; i++) {
+        std::map<std::string, Accumulator> res;
+        if(!load_shard(i, res)) todo.push_back(i);
+    }
+
+    std::atomic<size_t> next = 0;
+    std::mutex lock;
+    std::condition_variable changed;
+    size_t finished = 0;
+    std::vector<size_t> failed;
+
+    std::vector<std::thread> workers;
+    for(size_t w = 0; w < std::min(jobs, todo.size()); w++) {
+        workers.emplace_back([&]() {
+            for(size_t n; (n = next++) < todo.size(); ) {
+                bool ok = true;
+                try { finish_shard(todo[n]); }
+                catch (const std::runtime_error&) { ok = false; }
+
+                std::lock_guard<std::mutex> guard(lock);
+                if(!ok) failed.push_back(todo[n]);
+                finished++;
+                changed.notify_one();
+            }
+        });
+    }
+
+    // Progress gets reported from this thread only (and there is none
+    // when all shards were done already)
+    if(!todo.empty()) {
+        Progress p(progress, "Running shards", todo.size());
+        std::unique_lock<std::mutex> guard(lock);
+        for(size_t seen = 0; seen < todo.size(); ) {
+            changed.wait(guard, [&]() { return finished > seen; });
+            p.inc(finished - seen);
+            seen = finished;
+        }
+    }
+
+    for(auto &w : workers) w.join();
+
+    if(!failed.empty()) {
+        throw std::runtime_error(
+            std::to_string(failed.size()) + " shard(s) failed, run again to retry"
+        );
+    }
+
+    // Merge the results of all shards
+    TraceSpan span("Merge shards", shards);
+    std::map<std::string, Accumulator> merged;
+    for(size_t i = 0; i < shards; i++) {
+        std::map<std::string, Accumulator> res;
+        if(!load_shard(i, res)) {
+            throw std::runtime_error("Missing output of shard " + std::to_string(i));
+        }
+
+        for(auto &[guess, a] : res) {
+            auto [it, inserted] = merged.emplace(guess, a);
+            if(!inserted) it->second.merge(a);
+        }
+    }
+
+    SolveResult res = {};
+    res.guesses = best_of(merged, top_n);
+
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    res.seconds = took.count();
+    return res;
+}
@@ -0,0 +1,283 @@
+#include "daemon.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+
+// Default amount of suggestions and leftover words in a response
+#define DAEMON_SUGGESTION_C 10
+#define DAEMON_LEFT_C 50
+// Longest request line we accept
+#define DAEMON_LINE_MAX 4096
+// Pending connections before new ones get refused
+#define DAEMON_BACKLOG 64
+
+
+SolverDaemon::SolverDaemon(
+    std::string dict_name, size_t default_wlen,
+    std::shared_ptr<ResultCache> cache, double deadline
+) :
+    dict_name(dict_name), default_wlen(default_wlen), cache(cache),
+    deadline(deadline)
+{
+    // Load the default dictionary up front, so it is warm
+    game(default_wlen);
+}
+
+
+SolverDaemon::Game& SolverDaemon::game(size_t wlen) {
+    std::lock_guard<std::mutex> guard(games_lock);
+
+    auto &g = games[wlen];
+    if(!g) {
+        // Only kept once the dictionary loaded, so a failed load 
+        // gets another try next time
+        auto fresh = std::make_unique<Game>();
+        fresh->solver = std::make_unique<WordleSolver>(dict_name, wlen);
+        if(cache) fresh->solver->share_cache(cache);
+        g = std::move(fresh);
+    }
+
+    return *g;
+}
+
+
+std::shared_ptr<SolverDaemon::Session> SolverDaemon::session(
+    const std::string& id
+) {
+    std::lock_guard<std::mutex> guard(sessions_lock);
+
+    auto s = sessions.find(id);
+    if(s == sessions.end()) throw std::runtime_error("Unknown session");
+    return s->second;
+}
+
+
+std::string SolverDaemon::handle(
+    const std::string& request, std::vector<std::string>* opened
+) {
+    std::istringstream args(request);
+    std::string cmd;
+    args >> cmd;
+
+    try {
+        if(cmd == "NEW") return new_game(args, opened);
+        if(
+            cmd != "GUESS" && cmd != "SUGGEST" && cmd != "LEFT" && cmd != "END"
+        ) {
+            return "ERR Unknown command";
+        }
+
+        // Sessions of other connections are as good as unknown
+        std::string id;
+        std::istringstream(request) >> cmd >> id;
+        if(
+            opened && !id.empty() &&
+            std::find(opened->begin(), opened->end(), id) == opened->end()
+        ) {
+            throw std::runtime_error("Unknown session");
+        }
+
+        if(cmd == "GUESS") return guess(args);
+        if(cmd == "SUGGEST") return suggest(args);
+        if(cmd == "LEFT") return left(args);
+
+        std::string res = end(args);
+        if(opened) std::erase(*opened, id);
+        return res;
+    }
+
+    catch (const std::runtime_error& e) {
+        return std::string("ERR ") + e.what();
+    }
+}
+
+
+std::string SolverDaemon::new_game(
+    std::istream& args, std::vector<std::string>* opened
+) {
+    TraceSpan span("NEW");
+    size_t wlen = default_wlen;
+    args >> wlen;
+
+    if(wlen == 0 || wlen > MAX_WORD_LENGTH) {
+        throw std::runtime_error("Invalid word length");
+    }
+
+    auto s = std::make_shared<Session>(*game(wlen).solver);
+
+    std::lock_guard<std::mutex> guard(sessions_lock);
+    std::string id = std::to_string(next_session++);
+    sessions[id] = s;
+    if(opened) opened->push_back(id);
+
+    return "OK " + id;
+}
+
+
+std::string SolverDaemon::guess(std::istream& args) {
+    TraceSpan span("GUESS");
+    std::string id, word, marks;
+    if(!(args >> id >> word >> marks)) {
+        throw std::runtime_error("Usage: GUESS <session> <word> <marks>");
+    }
+
+    auto s = session(id);
+    std::lock_guard<std::mutex> guard(s->lock);
+
+    s->solver.update(word, marks);
+    return "OK " + std::to_string(s->solver.remaining_c());
+}
+
+
+std::string SolverDaemon::suggest(std::istream& args) {
+    TraceSpan span("SUGGEST");
+    std::string id;
+    size_t n = DAEMON_SUGGESTION_C;
+    if(!(args >> id)) throw std::runtime_error("Usage: SUGGEST <session> [n]");
+    args >> n;
+
+    auto s = session(id);
+    std::lock_guard<std::mutex> guard(s->lock);
+
+    if(s->solver.remaining_c() == 0) {
+        throw std::runtime_error("Word not in dictionary");
+    }
+
+    const SolveOptions opts = { .top_n = n, .deadline = deadline };
+    SolveResult res;
+
+    // The first round is the same for everyone, so it is only done once
+    // (or until it gets done in time, with a deadline)
+    if(s->solver.first_round()) {
+        Game& g = game(s->solver.length());
+        std::lock_guard<std::mutex> game_guard(g.lock);
+
+        if(g.opening.size() < n) {
+            res = s->solver.calculate_best_guess(opts);
+            if(!res.partial) g.opening = res.guesses;
+        }
+
+        if(!res.partial) {
+            res.guesses.assign(
+                g.opening.begin(),
+                g.opening.begin() + std::min(n, g.opening.size())
+            );
+        }
+    }
+
+    else { res = s->solver.calculate_best_guess(opts); }
+
+    std::ostringstream out;
+    out << "OK";
+    if(res.partial) out << " PARTIAL";
+    for(auto &[word, score] : res.guesses) out << " " << word << ":" << score;
+    return out.str();
+}
+
+
+std::string SolverDaemon::left(std::istream& args) {
+    TraceSpan span("LEFT");
+    std::string id;
+    size_t n = DAEMON_LEFT_C;
+    if(!(args >> id)) throw std::runtime_error("Usage: LEFT <session> [n]");
+    args >> n;
+
+    auto s = session(id);
+    std::lock_guard<std::mutex> guard(s->lock);
+
+    std::ostringstream out;
+    out << "OK " << s->solver.remaining_c();
+
+    for(auto &word : s->solver.remaining()) {
+        if(n-- == 0) break;
+        out << " " << word;
+    }
+
+    return out.str();
+}
+
+
+std::string SolverDaemon::end(std::istream& args) {
+    TraceSpan span("END");
+    std::string id;
+    if(!(args >> id)) throw std::runtime_error("Usage: END <session>");
+
+    std::lock_guard<std::mutex> guard(sessions_lock);
+    if(sessions.erase(id) == 0) throw std::runtime_error("Unknown session");
+    return "OK";
+}
+
+
+void SolverDaemon::serve(const std::string& socket_path) {
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(server < 0) throw std::runtime_error("Could not create socket");
+
+    sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if(socket_path.length() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long");
+    }
+    socket_path.copy(addr.sun_path, socket_path.length());
+
+    // Clean up after a previous run
+    unlink(socket_path.c_str());
+
+    if(
+        bind(server, (sockaddr*) &addr, sizeof(addr)) < 0 ||
+        listen(server, DAEMON_BACKLOG) < 0
+    ) {
+        close(server);
+        throw std::runtime_error("Could not listen on " + socket_path);
+    }
+
+    while(true) {
+        int client = accept(server, nullptr, nullptr);
+        if(client < 0) continue;
+
+        std::thread(&SolverDaemon::serve_client, this, client).detach();
+    }
+}
+
+
+void SolverDaemon::serve_client(int fd) {
+    std::string buffer;
+    // Sessions started over this connection
+    std::vector<std::string> opened;
+    bool quit = false;
+    char chunk[DAEMON_LINE_MAX];
+
+    while(!quit) {
+        ssize_t n = recv(fd, chunk, sizeof(chunk), 0);
+        if(n <= 0) break;
+        buffer.append(chunk, n);
+
+        // Answer every complete line we have
+        size_t eol;
+        while((eol = buffer.find('\n')) != std::string::npos) {
+            std::string request = buffer.substr(0, eol);
+            buffer.erase(0, eol + 1);
+
+            if(!request.empty() && request.back() == '\r') request.pop_back();
+            if(request == "QUIT") { quit = true; break; }
+
+            std::string response = handle(request, &opened) + "\n";
+            send(fd, response.data(), response.size(), MSG_NOSIGNAL);
+        }
+
+        if(buffer.size() > DAEMON_LINE_MAX) break;
+    }
+
+    close(fd);
+
+    // Whatever the client did not END itself
+    std::lock_guard<std::mutex> guard(sessions_lock);
+    for(auto &id : opened) sessions.erase(id);
+}
@@ -0,0 +1,363 @@
+#include "dictionary.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+
+// Compiled dictionary layout: a FileHeader, followed by one SectionHeader
+// per word length, followed by the data blocks those sections point to.
+// Every block starts at a multiple of 8 bytes from the start of the file.
+#define DICT_MAGIC "BFDICT\0\0"
+#define DICT_VERSION 2
+
+namespace {
+    struct FileHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t sections;
+    };
+
+    struct SectionHeader {
+        uint32_t wlen;
+        uint32_t count;
+        // Bytes of the alphabet block (its letters, as UTF-8)
+        uint32_t alphabet_size;
+        uint32_t reserved;
+        // Byte offsets of the blocks, from the start of the file
+        uint64_t alphabet;
+        uint64_t words;
+        uint64_t counts;
+        uint64_t masks;
+        uint64_t offsets;
+        uint64_t pos;
+    };
+
+    // The indexes we store alongside each set of words
+    struct Indexes {
+        std::vector<uint8_t> counts;
+        std::vector<lmask_t> masks;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> pos;
+    };
+
+
+    // Reads all (UTF-8) words that consist of only letters, in lower
+    // case and split into letters
+    std::vector<std::u32string> read_words(const std::string& filename) {
+        std::vector<std::u32string> res;
+        std::ifstream dict_file(filename);
+
+        if(!dict_file.is_open()) {
+            throw std::runtime_error("Error reading file.");
+        }
+
+        // Empty itertor is OEF
+        std::for_each(
+            std::istream_iterator<std::string>(dict_file),
+            std::istream_iterator<std::string>(),
+            [&res](const std::string &s) {
+                std::u32string word = letters_of(s);
+                if(!word.empty()) res.push_back(std::move(word));
+            }
+        );
+
+        return res;
+    }
+
+
+    // Finds the alphabet of words, and writes them out in its inner form
+    Alphabet encode_words(
+        const std::vector<std::u32string>& words, std::string& out
+    ) {
+        std::u32string letters;
+        for(auto &word : words) letters += word;
+
+        Alphabet res(std::move(letters));
+        for(auto &word : words) out += res.encode(word);
+        return res;
+    }
+
+
+    Indexes build_indexes(
+        const std::string& words, size_t wlen, size_t letters
+    ) {
+        Indexes res;
+        size_t count = wlen ? words.size() / wlen : 0;
+
+        res.counts.assign(count * letters, 0);
+        res.masks.assign(count, 0);
+
+        // Bucket the words on (position, letter) first
+        std::vector<std::vector<uint32_t>> buckets(wlen * letters);
+
+        for(size_t w = 0; w < count; w++) {
+            res.masks[w] = letter_counts(
+                &words[w*wlen], wlen, &res.counts[w*letters]
+            );
+
+            for(size_t p = 0; p < wlen; p++) {
+                buckets[p*letters + letter_index(words[w*wlen + p])]
+                    .push_back(w);
+            }
+        }
+
+        // Then flatten the buckets into compressed rows
+        res.offsets.reserve(buckets.size() + 1);
+        res.pos.reserve(count * wlen);
+        res.offsets.push_back(0);
+
+        for(auto &b : buckets) {
+            res.pos.insert(res.pos.end(), b.begin(), b.end());
+            res.offsets.push_back(res.pos.size());
+        }
+
+        return res;
+    }
+
+
+    // Writes a block, padded to 8 bytes, and returns where it starts
+    uint64_t write_block(std::ofstream& out, const void* data, size_t n) {
+        uint64_t start = out.tellp();
+        out.write(static_cast<const char*>(data), n);
+
+        static const char zeros[8] = {};
+        out.write(zeros, (8 - n % 8) % 8);
+        return start;
+    }
+}
+
+
+lmask_t letter_counts(const char* word, size_t wlen, uint8_t* counts) {
+    lmask_t mask = 0;
+
+    for(size_t p = 0; p < wlen; p++) {
+        size_t l = letter_index(word[p]);
+        counts[l]++;
+        mask |= lmask_t(1) << l;
+    }
+
+    return mask;
+}
+
+
+Dictionary::~Dictionary() {
+    if(mapping) munmap(mapping, mapping_size);
+}
+
+
+std::shared_ptr<const Dictionary> Dictionary::load(
+    const std::string& filename, size_t wlen
+) {
+    TraceSpan span("Load dictionary");
+
+    // (Constraints keep the positions of a letter in a 64 bit mask)
+    if(wlen == 0 || wlen > MAX_WORD_LENGTH) {
+        throw std::runtime_error("Word length has to be 1 to "
+            + std::to_string(MAX_WORD_LENGTH));
+    }
+
+    // The constructor is private, so no make_shared
+    std::shared_ptr<Dictionary> res(new Dictionary());
+    res->wlen = wlen;
+
+    if(!res->map_compiled(filename, wlen)) {
+        res->read_text(filename, wlen);
+    }
+
+    return res;
+}
+
+
+void Dictionary::read_text(const std::string& filename, size_t wlen) {
+    // Only keeps words of length wlen
+    auto all = read_words(filename);
+    std::erase_if(all, [wlen](auto &w) { return w.length() != wlen; });
+
+    alpha = encode_words(all, own_words);
+    auto idx = build_indexes(own_words, wlen, alpha.size());
+    own_counts = std::move(idx.counts);
+    own_masks = std::move(idx.masks);
+    own_offsets = std::move(idx.offsets);
+    own_pos = std::move(idx.pos);
+
+    count = own_masks.size();
+    words = own_words.data();
+    letter_counts = own_counts.data();
+    masks = own_masks.data();
+    pos_offsets = own_offsets.data();
+    pos_words = own_pos.data();
+}
+
+
+bool Dictionary::map_compiled(const std::string& filename, size_t wlen) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if(fd < 0) throw std::runtime_error("Error reading file.");
+
+    // Anything without our header is treated as a text dictionary
+    FileHeader header;
+    if(
+        pread(fd, &header, sizeof(header), 0) != sizeof(header) ||
+        std::memcmp(header.magic, DICT_MAGIC, sizeof(header.magic)) != 0
+    ) {
+        close(fd);
+        return false;
+    }
+
+    if(header.version != DICT_VERSION) {
+        close(fd);
+        throw std::runtime_error("Unsupported compiled dictionary version.");
+    }
+
+    struct stat st;
+    if(fstat(fd, &st) < 0) {
+        close(fd);
+        throw std::runtime_error("Error reading file.");
+    }
+    mapping_size = st.st_size;
+    mapping = mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if(mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("Could not map compiled dictionary.");
+    }
+
+    const char* base = static_cast<const char*>(mapping);
+    auto sections = reinterpret_cast<const SectionHeader*>(
+        base + sizeof(FileHeader)
+    );
+
+    // True if n items of size bytes at offset lie within the file, and 
+    // are aligned like they need to be (without overflowing on garbage)
+    auto fits = [&](uint64_t offset, uint64_t n, uint64_t size) {
+        return offset <= mapping_size 
+            && offset % std::min<uint64_t>(size, alignof(uint64_t)) == 0
+            && n <= (mapping_size - offset) / size;
+    };
+    const std::runtime_error corrupt("Compiled dictionary is corrupt.");
+
+    if(!fits(sizeof(FileHeader), header.sections, sizeof(SectionHeader))) {
+        throw corrupt;
+    }
+
+    for(size_t i = 0; i < header.sections; i++) {
+        const SectionHeader& s = sections[i];
+        if(s.wlen != wlen) continue;
+
+        if(!fits(s.alphabet, s.alphabet_size, 1)) throw corrupt;
+        alpha = Alphabet(letters_of({base + s.alphabet, s.alphabet_size}));
+
+        const uint64_t n = (uint64_t) s.count * wlen;
+        const uint64_t rows = (uint64_t) wlen * alpha.size();
+        if(
+            !fits(s.words, n, 1) ||
+            !fits(s.counts, (uint64_t) s.count * alpha.size(), 1) ||
+            !fits(s.masks, s.count, sizeof(lmask_t)) ||
+            !fits(s.offsets, rows + 1, sizeof(uint32_t)) ||
+            !fits(s.pos, n, sizeof(uint32_t))
+        ) {
+            throw corrupt;
+        }
+
+        count = s.count;
+        words = base + s.words;
+        letter_counts = reinterpret_cast<const uint8_t*>(base + s.counts);
+        masks = reinterpret_cast<const lmask_t*>(base + s.masks);
+        pos_offsets = reinterpret_cast<const uint32_t*>(base + s.offsets);
+        pos_words = reinterpret_cast<const uint32_t*>(base + s.pos);
+
+        // The rows of the position index have to stay within it as well
+        for(size_t r = 0; r < rows; r++) {
+            if(pos_offsets[r] > pos_offsets[r + 1]) throw corrupt;
+        }
+        if(pos_offsets[rows] > n) throw corrupt;
+
+        return true;
+    }
+
+    // No words of this length: leave it empty, like a text file would
+    own_offsets.assign(1, 0);
+    pos_offsets = own_offsets.data();
+    return true;
+}
+
+
+std::span<const uint32_t> Dictionary::with_letter_at(size_t p, char l) const {
+    size_t row = p*alpha.size() + letter_index(l);
+    return std::span<const uint32_t>(
+        pos_words + pos_offsets[row], pos_words + pos_offsets[row + 1]
+    );
+}
+
+
+void Dictionary::compile(
+    const std::string& in_file, const std::string& out_file
+) {
+    // Partition the words by length, keeping the original order
+    std::map<size_t, std::vector<std::u32string>> by_length;
+    for(auto &word : read_words(in_file)) {
+        if(word.length() <= MAX_WORD_LENGTH) {
+            by_length[word.length()].push_back(std::move(word));
+        }
+    }
+
+    std::ofstream out(out_file, std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) {
+        throw std::runtime_error("Error writing file.");
+    }
+
+    FileHeader header;
+    std::memcpy(header.magic, DICT_MAGIC, sizeof(header.magic));
+    header.version = DICT_VERSION;
+    header.sections = by_length.size();
+
+    // Reserve room for the headers, and fill them in once we know
+    // where all the blocks ended up
+    std::vector<SectionHeader> sections;
+    write_block(out, &header, sizeof(header));
+    out.seekp(sizeof(FileHeader) + by_length.size() * sizeof(SectionHeader));
+
+    for(auto &[wlen, letters] : by_length) {
+        // Every length gets the alphabet its own words use
+        std::string words;
+        Alphabet alpha = encode_words(letters, words);
+        std::string alpha_utf8 = alpha.utf8();
+        auto idx = build_indexes(words, wlen, alpha.size());
+
+        SectionHeader s = {};
+        s.wlen = wlen;
+        s.count = idx.masks.size();
+        s.alphabet_size = alpha_utf8.size();
+        s.alphabet = write_block(out, alpha_utf8.data(), alpha_utf8.size());
+        s.words = write_block(out, words.data(), words.size());
+        s.counts = write_block(out, idx.counts.data(), idx.counts.size());
+        s.masks = write_block(
+            out, idx.masks.data(), idx.masks.size() * sizeof(lmask_t)
+        );
+        s.offsets = write_block(
+            out, idx.offsets.data(), idx.offsets.size() * sizeof(uint32_t)
+        );
+        s.pos = write_block(
+            out, idx.pos.data(), idx.pos.size() * sizeof(uint32_t)
+        );
+        sections.push_back(s);
+    }
+
+    out.seekp(sizeof(FileHeader));
+    out.write(
+        reinterpret_cast<const char*>(sections.data()),
+        sections.size() * sizeof(SectionHeader)
+    );
+
+    if(!out) throw std::runtime_error("Error writing file.");
+}
@@ -17,22 +17,23 @@ size_t EvalNode::size() const {
 }
 
 
-void EvalNode::print(const int depth) const {
+void EvalNode::print(std::ostream& s, const int depth) const {
     for(auto &[g,c] : children) {
         // Indent to the depth level
-        std::cout << std::string(4*depth, ' ');
-        std::cout << *g;
-        std::cout << std::endl;
+        s << std::string(4*depth, ' ');
+        s << *g;
+        s << std::endl;
 
         // Recurse with increaded depth
-        c->print(depth+1);
+        c->print(s, depth+1);
     }
 }
 
 
 void EvalNode::insert(
     std::vector<std::unique_ptr<const LetterEval>>& q, 
-    const size_t idx
+    const size_t idx,
+    const size_t m
 ) {
     if(idx == q.size()) return;
 
@@ -41,11 +42,16 @@ void EvalNode::insert(
     );
     const auto &[_,node] = *child;
 
+    // This is a new leaf, it occurs m times
+    if(inserted && idx + 1 == q.size()) {
+        node->multiplicity = m;
+    }
+
     // This is a duplicate leaf inc multiplicity
-    if(!inserted && node->children.empty()) { 
-        node->multiplicity++; 
+    else if(!inserted && node->children.empty()) { 
+        node->multiplicity += m; 
     }
 
-    node->insert(q, idx+1);
+    node->insert(q, idx+1, m);
 }
 
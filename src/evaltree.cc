@@ -1,80 +1,175 @@
 #include "evaltree.h"
-
+#include "dictionary.h"
+#include "histogram.h"
+#include "memstats.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <array>
+#include <condition_variable>
+#include <exception>
 #include <memory>
+#include <mutex>
 #include <numeric>
+#include <stdexcept>
+#include <thread>
 #include <assert.h>
-#include <iomanip>
 #include <unordered_map>
 
 
-// When there are fewer words left than this 
-// number we start listing them out
-#define SHOW_LEFT_C 8
-// Column width for suggestion table
-#define COL_W 15
-// Number of suggestions in the table
-#define SUGGESTION_C 10
-// Number of evaluations to work out before inserting
-#define BATCH_C
+// Number of evaluations to work out before inserting (for long words)
+#define BATCH_C 4096
+// Batches that can be worked out ahead of the one being inserted
+#define PIPELINE_DEPTH 2
+
+
+namespace {
+    // Runs produce(i) for every batch i < n on a thread of its own, while
+    // consume(i) runs on the calling thread, in order. produce gets at
+    // most depth batches ahead, so batch i can use buffer i % (depth + 1).
+    // Whatever either of them throws ends both, and comes out of here.
+    // With a single core the two just take turns
+    template<class P, class C>
+    void pipeline(size_t n, size_t depth, P produce, C consume) {
+        if(n <= 1 || std::thread::hardware_concurrency() <= 1) {
+            for(size_t i = 0; i < n; i++) { produce(i); consume(i); }
+            return;
+        }
+
+        std::mutex lock;
+        std::condition_variable changed;
+        size_t produced = 0, consumed = 0;
+        bool stop = false;
+        std::exception_ptr error;
+
+        std::thread producer([&]() {
+            try {
+                for(size_t i = 0; i < n; i++) {
+                    {
+                        std::unique_lock<std::mutex> guard(lock);
+                        changed.wait(guard, [&]() {
+                            return stop || i <= consumed + depth;
+                        });
+                        if(stop) return;
+                    }
+
+                    produce(i);
+
+                    std::lock_guard<std::mutex> guard(lock);
+                    produced = i + 1;
+                    changed.notify_all();
+                }
+            }
+
+            catch (...) {
+                std::lock_guard<std::mutex> guard(lock);
+                error = std::current_exception();
+                changed.notify_all();
+            }
+        });
+
+        try {
+            for(size_t i = 0; i < n; i++) {
+                {
+                    std::unique_lock<std::mutex> guard(lock);
+                    changed.wait(guard, [&]() { return produced > i || error; });
+                    if(error) std::rethrow_exception(error);
+                }
+
+                consume(i);
+
+                std::lock_guard<std::mutex> guard(lock);
+                consumed = i + 1;
+                changed.notify_all();
+            }
+        }
+
+        catch (...) {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                stop = true;
+                changed.notify_all();
+            }
+            producer.join();
+            throw;
+        }
+
+        producer.join();
+    }
+
+
+    // All words back to back, so a tile of them is contiguous
+    std::string flatten(const std::vector<const std::string*>& words) {
+        std::string res;
+        res.reserve(words.size() * (words.empty() ? 0 : words.front()->size()));
+        for(auto &word : words) res += *word;
+        return res;
+    }
+}
 
 
 EvalTree::EvalTree(
-    std::list<std::string>* wl,
-    std::list<std::string>* d, 
-    std::string g
+    const std::list<std::string>* wl,
+    const std::list<std::string>* d, 
+    std::string g,
+    const Kernels& k,
+    ProgressFn progress,
+    Tiling t
 ) :   
-    guessed(g), dict(d), words_left(wl),
-    wlen(d->front().length()),
+    guessed(g), dict(d), words_left(wl), answers(*wl, d->front().length()),
+    wlen(d->front().length()), kern(k), progress_fn(progress), tile(t),
     root(std::make_unique<EvalNode>()),
     scores(std::make_unique<scoremap>())
 {
+    find_representatives();
     generate_evaluations();
     generate_elims();
 }
 
 
+// Tearing down a big tree takes a while, this makes it show up in traces
+EvalTree::~EvalTree() {
+    TraceSpan span("Free tree");
+    root->children.clear();
+}
+
+
 std::vector<std::unique_ptr<const LetterEval>> 
-EvalTree::evaluate(const std::string& guess, std::string word) {
+EvalTree::evaluate(const std::string& guess, const uint8_t* marks) {
+    MemoryScope scope(MEM_EVALS);
     std::vector<std::unique_ptr<const LetterEval>> res;
     res.reserve(wlen);
 
-    std::map<char,int> allow;
+    std::array<uint8_t, MAX_ALPHABET_C> allow = {};
     for(auto &c : guessed) { 
-        if(c != '.') allow[c]++; 
+        if(c != '.') allow[letter_index(c)]++; 
     }
 
     std::vector<int> todo;
     todo.reserve(wlen);
 
-    for(size_t i = 0; i < wlen; i++) {
+    for(int i = 0; i < wlen; i++) {
         // Correct letter
-        if(guess[i] == word[i]) {
+        if(marks[i] == FB_RIGHT) {
             res.emplace_back(std::make_unique<EvalRight>(i, guess[i]));
-            allow[guess[i]]++;
-            word[i] = '.';
+            allow[letter_index(guess[i])]++;
         }
 
         // Wrong position
-        else {
-            size_t loc = word.find(guess[i]);
-            while(loc != std::string::npos && guess[loc] == word[loc]) {
-                loc = word.find(guess[i], loc + 1);
-            }
-
-            if(loc != std::string::npos) {
-                res.emplace_back(std::make_unique<EvalPlace>(i, guess[i]));
-                allow[guess[i]]++;
-                word[loc] = '.';
-            }
-            
-            // Not in word, fill in later
-            else { todo.push_back(i); }
+        else if(marks[i] == FB_PLACE) {
+            res.emplace_back(std::make_unique<EvalPlace>(i, guess[i]));
+            allow[letter_index(guess[i])]++;
         }
+            
+        // Not in word, fill in later
+        else { todo.push_back(i); }
     }
 
     for(auto &i : todo) {
         res.emplace_back(
-            std::make_unique<EvalWrong>(i, guess[i], allow[guess[i]])
+            std::make_unique<EvalWrong>(
+                i, guess[i], allow[letter_index(guess[i])]
+            )
         );
     }
 
@@ -82,20 +177,187 @@ EvalTree::evaluate(const std::string& guess, std::string word) {
 }
 
 
+size_t EvalTree::footprint(
+    size_t guesses, size_t answers, size_t wlen, Tiling tile
+) {
+    // Both lists of words, flattened, and the letter counts and masks
+    size_t fixed = 
+        guesses * wlen + answers * (wlen + MAX_ALPHABET_C + sizeof(lmask_t));
+    size_t per_guess = ELIM_BYTES + wlen;
+
+    if(wlen > FCODE_MAX_LENGTH) {
+        // (The batches of marks in flight)
+        fixed += (PIPELINE_DEPTH + 1) * BATCH_C * wlen;
+        per_guess += answers * wlen * TREE_NODE_BYTES;
+        return fixed + guesses * per_guess;
+    }
+
+    // The histograms of a block of guesses, for every block in flight
+    size_t hist = Histogram::footprint(wlen, answers);
+    fixed += 
+        (PIPELINE_DEPTH + 1) * auto_tiling(tile, wlen, hist).guesses * hist;
+
+    // Every distinct feedback is one path
+    size_t paths = 1;
+    for(size_t i = 0; i < wlen && paths < answers; i++) paths *= 3;
+    per_guess += std::min(paths, answers) * wlen * TREE_NODE_BYTES;
+
+    return fixed + guesses * per_guess;
+}
+
+
+// A letter that is in none of the remaining words gets marked wrong
+// everywhere, and rules out nothing. So guesses that only differ in
+// such letters split the remaining words in exactly the same way
+void EvalTree::find_representatives() {
+    TraceSpan span("Find representatives", dict->size());
+    lmask_t present = 0;
+    for(size_t i = 0; i < answers.size(); i++) present |= answers.mask(i);
+
+    // Guesses by their letters, with the absent ones blanked out
+    std::unordered_map<std::string, const std::string*> classes;
+
+    for(auto &guess : *dict) {
+        std::string key = guess;
+        bool informative = false;
+
+        for(auto &c : key) {
+            if(present & (lmask_t(1) << letter_index(c))) informative = true;
+            else c = '.';
+        }
+
+        if(!informative) { uninformative.push_back(&guess); continue; }
+
+        auto [rep, added] = classes.emplace(key, &guess);
+        if(added) representatives.push_back(&guess);
+        else equivalent.emplace_back(&guess, rep->second);
+    }
+}
+
+
 // Calculates all possible evaluations and stores
 // them in a compressed (and sorted) tree container
 void EvalTree::generate_evaluations() {
-    std::cout << "\nCalculating all possible evaluations\n";
-    lbar = std::make_unique<LoadingBar>(dict->size()*words_left->size());
+    if(wlen > FCODE_MAX_LENGTH) { generate_long_evaluations(); return; }
+    TraceSpan span("Generate evaluations", representatives.size());
+
+    progress = std::make_unique<Progress>(
+        progress_fn, "Calculating all possible evaluations",
+        representatives.size()*words_left->size()
+    );
+
+    const std::string guesses = [&]() {
+        MemoryScope scope(MEM_WORDS);
+        return flatten(representatives);
+    }();
+    const size_t guess_c = representatives.size();
+    const size_t answer_c = words_left->size();
+
+    const Tiling t = auto_tiling(
+        tile, wlen, Histogram::footprint(wlen, answer_c)
+    );
+
+    // A set of histograms per tile that can be in flight
+    const size_t tiles = (guess_c + t.guesses - 1) / t.guesses;
+    std::vector<std::vector<Histogram>> hists = [&]() {
+        MemoryScope scope(MEM_HIST);
+        return std::vector<std::vector<Histogram>>(
+            PIPELINE_DEPTH + 1,
+            std::vector<Histogram>(t.guesses, Histogram(wlen))
+        );
+    }();
+
+    // The feedback of the guesses of a tile, in one tight loop...
+    auto fill = [&](size_t tile) {
+        const size_t g0 = tile * t.guesses;
+        const size_t g1 = std::min(g0 + t.guesses, guess_c);
+        TraceSpan filling("Fill histograms", g1 - g0);
+        // (Possibly on another thread, which has a scope of its own)
+        MemoryScope scope(MEM_HIST);
+
+        fill_histograms(
+            hists[tile % (PIPELINE_DEPTH + 1)].data(), &guesses[g0 * wlen],
+            g1 - g0, answers, kern, t.answers
+        );
+    };
+
+    // ...worked out ahead of putting the tile before it in the tree
+    auto insert_tile = [&](size_t tile) {
+        const size_t g0 = tile * t.guesses;
+        const size_t g1 = std::min(g0 + t.guesses, guess_c);
+        TraceSpan inserting("Insert evaluations", g1 - g0);
+        uint8_t marks[MAX_WORD_LENGTH];
+
+        for(size_t g = g0; g < g1; g++) {
+            Histogram &hist = hists[tile % (PIPELINE_DEPTH + 1)][g - g0];
+            const std::string& guess = *representatives[g];
+
+            // Words with the same feedback take the same path through the
+            // tree, so we only have to insert each distinct feedback once
+            // (for long words, nearly every feedback is distinct)
+            hist.for_each([&](fcode_t code, size_t c) {
+                kern.decode(code, marks, wlen);
+                auto evaluation = evaluate(guess, marks);
+                insert(evaluation, c);
+            });
+
+            hist.clear();
+        }
 
-    for(auto &guess : *dict) {
-        for(auto &word : *words_left) {
-            auto evaluation = evaluate(guess, word);
-            insert(evaluation);
+        progress->inc((g1 - g0) * answer_c);
+    };
+
+    pipeline(tiles, PIPELINE_DEPTH, fill, insert_tile);
+}
+
+
+void EvalTree::generate_long_evaluations() {
+    TraceSpan span("Generate evaluations", representatives.size());
+    progress = std::make_unique<Progress>(
+        progress_fn, "Calculating all possible evaluations",
+        representatives.size()*words_left->size()
+    );
+
+    // Too long to pack, so every evaluation gets inserted on its own.
+    // Pairs of a guess and an answer, the guesses one after the other
+    const size_t answer_c = answers.size();
+    const size_t pairs = representatives.size() * answer_c;
+    const size_t batches = (pairs + BATCH_C - 1) / BATCH_C;
+
+    std::vector<std::vector<uint8_t>> marks = [&]() {
+        MemoryScope scope(MEM_EVALS);
+        return std::vector<std::vector<uint8_t>>(
+            PIPELINE_DEPTH + 1, std::vector<uint8_t>(BATCH_C * wlen)
+        );
+    }();
+
+    // The marks of a batch of pairs, in one tight loop...
+    auto mark = [&](size_t batch) {
+        const size_t p0 = batch * BATCH_C;
+        const size_t p1 = std::min(p0 + BATCH_C, pairs);
+        uint8_t* out = marks[batch % (PIPELINE_DEPTH + 1)].data();
+
+        for(size_t p = p0; p < p1; p++, out += wlen) {
+            const std::string& guess = *representatives[p / answer_c];
+            kern.marks(guess.data(), answers.word(p % answer_c), out, wlen);
         }
+    };
 
-        lbar->inc(words_left->size());
-    }
+    // ...worked out ahead of inserting the batch before it
+    auto insert_batch = [&](size_t batch) {
+        const size_t p0 = batch * BATCH_C;
+        const size_t p1 = std::min(p0 + BATCH_C, pairs);
+        const uint8_t* in = marks[batch % (PIPELINE_DEPTH + 1)].data();
+
+        for(size_t p = p0; p < p1; p++, in += wlen) {
+            auto evaluation = evaluate(*representatives[p / answer_c], in);
+            insert(evaluation, 1);
+        }
+
+        progress->inc(p1 - p0);
+    };
+
+    pipeline(batches, PIPELINE_DEPTH, mark, insert_batch);
 }
 
 
@@ -106,26 +368,19 @@ size_t EvalTree::size() const {
 
 
 // Recusrive wrapper
-void EvalTree::print() const { 
-    std::cout << "\n"; 
-    root->print(0); 
+void EvalTree::print(std::ostream& s) const { 
+    s << "\n"; 
+    root->print(s, 0); 
 }
 
 
 // Recusrive wrapper
 void EvalTree::insert(
-    std::vector<std::unique_ptr<const LetterEval>>& q
+    std::vector<std::unique_ptr<const LetterEval>>& q,
+    const size_t multiplicity
 ) { 
-    root->insert(q, 0); 
-}
-
-
-// Writing this out mid-function is too ugly and hinders readability imo
-bool list_contains(
-    const std::list<std::string>* l, 
-    const std::string& s
-) {
-    return std::find(l->begin(), l->end(), s) != l->end();
+    MemoryScope scope(MEM_TREE);
+    root->insert(q, 0, multiplicity); 
 }
 
 
@@ -134,28 +389,39 @@ void EvalTree::generate_elims() {
     size_t wlen = dict->front().length();
 
     // Calculate the leftover wordscounts for each evaluation
-    std::cout << "\nCalculating elimininations\n";
-    lbar = std::make_unique<LoadingBar>(size());
+    progress = std::make_unique<Progress>(
+        progress_fn, "Calculating elimininations", size()
+    );
+    MemoryScope scope(MEM_ELIMS);
+
+    // (The tree is empty if the words were too long for it)
+    if(!root->children.empty()) {
+        TraceSpan span("Eliminations", size());
+        auto words = answers.all();
+        Constraint none;
+        get_e(
+            std::string(wlen, ' '), root.get(),
+            words.data(), words.data() + words.size(), none
+        );
+    }
 
-    auto tmp_dict = *words_left;
-    get_e(std::string(wlen, ' '), root.get(), tmp_dict);
+    // Guesses that were not worked out themselves
+    for(auto &[guess, rep] : equivalent) elims[*guess] = elims[*rep];
+    for(auto &guess : uninformative) {
+        elims[*guess].add(words_left->size(), words_left->size());
+    }
 
     // Calculate the averages per word
-    std::cout << "\nCalculating averages\n";
-    lbar = std::make_unique<LoadingBar>(elims.size());
+    progress = std::make_unique<Progress>(
+        progress_fn, "Calculating averages", elims.size()
+    );
 
-    leftover_scores.clear();
+    MemoryScope score_scope(MEM_SCORES);
+    TraceSpan span("Averages", elims.size());
     for(auto &[w,a] : elims) {
-        if( // Easy lookup for leftover words
-            words_left->size() <= SHOW_LEFT_C &&
-            list_contains(words_left, w)
-        ) { 
-            leftover_scores[w] = a.avg(); 
-        }
-
         // Uses a map (score->word) such that scores are sorted upon insertion
         (*scores)[a.avg()].push_back(w);
-        lbar->inc();
+        progress->inc();
     }
 }
 
@@ -163,75 +429,124 @@ void EvalTree::generate_elims() {
 void EvalTree::get_e(
     std::string s, 
     const EvalNode* cur,
-    const std::list<std::string>& d
+    uint32_t* first,
+    uint32_t* last,
+    Constraint& pending
 ) {
+    // A single child shares all of its words with us,
+    // so filtering can wait until the paths split
+    if(cur->children.size() == 1) {
+        auto &[guess, next] = *cur->children.begin();
+        pending.add(*guess);
+
+        s[guess->idx] = guess->letter;
+        get_e(s, next.get(), first, last, pending);
+        return;
+    }
+
+    // Apply everything since the last split in one pass. The children
+    // only reorder the words that fit, so they can share the range
+    if(!pending.empty()) last = pending.partition(first, last, answers);
+
     // End of recursion, store result
     if(cur->children.empty()) {
         // This is where the compression happens:
         // We have tracked how often this path occurs in the
         // multiplicity field of the leaf. We can now simply
         // add the result of this path that number of times.
-        elims[s].add(d.size(), cur->multiplicity);
+        elims[s].add(last - first, cur->multiplicity);
 
-        lbar->inc(cur->multiplicity);
+        progress->inc(cur->multiplicity);
         return;
     }
 
     // Recurse over all children
     for(auto &[guess, next] : cur->children) {
-        // We need a copies to filter down
-        std::list<std::string> td(d);
-
-        guess->filter(&td);
+        Constraint c;
+        c.add(*guess);
 
         // Build up the word and recurse
         s[guess->idx] = guess->letter;
-        get_e(s, next.get(), td);
+        get_e(s, next.get(), first, last, c);
     }
 }
 
 
-// Suggest the most useful guesses
-void EvalTree::best_guesses() const {
-    std::cout 
-        << "\n\nBEST GUESSES:\n"
-        << std::setw(COL_W) << std::left << "Guessed word" 
-        << std::setw(COL_W) << std::left << "Avg words after\n";
-    
-    int done = 0;
+std::vector<Suggestion> EvalTree::ranking(size_t n) const {
+    TraceSpan span("Ranking", n);
+    std::vector<Suggestion> res;
+
     for(auto &[score, words] : *scores) {
         for(auto &word : words) {
-            std::cout 
-                << std::setw(COL_W) << std::left << word
-                << std::setw(COL_W) << std::left << score
-                << std::endl;
-
-            if(++done >= SUGGESTION_C) return;
+            if(res.size() >= n) return res;
+            res.push_back({word, score});
         }
     }
+
+    return res;
 }
 
 
-// Show the current status of the game
-void EvalTree::show_remaining() const {
-    std::cout 
-        << "\nGuessed so far: [" << guessed << "]\n\n"
-        << "POSSIBLE WORDS: " << words_left->size() << "\n";
+std::vector<Suggestion> EvalTree::candidates() const {
+    std::vector<Suggestion> res;
+    res.reserve(words_left->size());
+
+    for(auto &word : *words_left) {
+        auto e = elims.find(word);
+        if(e != elims.end()) res.push_back({word, e->second.avg()});
+    }
+
+    return res;
+}
+
 
-    if(words_left->size() <= SHOW_LEFT_C) {
-        std::cout
-            << std::setw(COL_W) << std::left << "Guessed word" 
-            << std::setw(COL_W) << std::left << "Avg words after\n";
+void write_accumulators(
+    std::ostream& out, const std::map<std::string, Accumulator>& acc
+) {
+    for(auto &[guess, a] : acc) {
+        out << guess << " " << a.total << " " << a.count << "\n";
     }
-    
-    if(words_left->size() <= SHOW_LEFT_C) {
-        for(auto &word : *words_left) {
-            std::cout 
-                << std::setw(COL_W) << std::left << word
-                << std::setw(COL_W) << std::left << leftover_scores.at(word)
-                << std::endl;
+
+    out << "END " << acc.size() << "\n";
+}
+
+
+std::map<std::string, Accumulator> read_accumulators(std::istream& in) {
+    std::map<std::string, Accumulator> res;
+    std::string guess;
+
+    while(in >> guess) {
+        if(guess == "END") {
+            size_t lines;
+            if(in >> lines && lines == res.size()) return res;
+            break;
         }
+
+        Accumulator a;
+        if(!(in >> a.total >> a.count)) break;
+        res[guess] = a;
     }
-    std::cout << "\n";
+
+    throw std::runtime_error("Incomplete list of accumulators");
 }
 
+
+std::vector<Suggestion> best_of(
+    const std::map<std::string, Accumulator>& acc, size_t n
+) {
+    std::vector<Suggestion> all;
+    all.reserve(acc.size());
+    for(auto &[guess, a] : acc) all.push_back({guess, a.avg()});
+
+    // Ties are broken alphabetically, like the scoremap does
+    n = std::min(n, all.size());
+    std::partial_sort(
+        all.begin(), all.begin() + n, all.end(),
+        [](const Suggestion& a, const Suggestion& b) {
+            return a.score < b.score || (a.score == b.score && a.word < b.word);
+        }
+    );
+
+    all.resize(n);
+    return all;
+}
@@ -0,0 +1,88 @@
+#include "heuristic.h"
+#include "dictionary.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+
+namespace {
+    // -p log p, for the probability c / n
+    double plogp(size_t c, size_t n) {
+        if(c == 0 || c == n) return 0;
+        double p = (double) c / n;
+        return -p * std::log2(p);
+    }
+}
+
+
+std::vector<const std::string*> heuristic_ranking(
+    const std::list<std::string>& guesses,
+    const std::list<std::string>& answers
+) {
+    TraceSpan span("Heuristic ranking", guesses.size());
+    std::vector<const std::string*> res;
+    if(guesses.empty()) return res;
+
+    const size_t wlen = guesses.front().length();
+    const size_t n = answers.size();
+
+    // How many words have letter l at position p, and anywhere
+    std::vector<size_t> at(wlen * MAX_ALPHABET_C, 0);
+    size_t anywhere[MAX_ALPHABET_C] = {};
+
+    for(auto &word : answers) {
+        lmask_t seen = 0;
+
+        for(size_t p = 0; p < wlen; p++) {
+            size_t l = letter_index(word[p]);
+            at[p * MAX_ALPHABET_C + l]++;
+            seen |= lmask_t(1) << l;
+        }
+
+        for(; seen; seen &= seen - 1) anywhere[std::countr_zero(seen)]++;
+    }
+
+    // The entropy of the split a letter makes at a position, in full,
+    // and for only telling whether the letter is there or not
+    std::vector<double> split(wlen * MAX_ALPHABET_C);
+    std::vector<double> there(wlen * MAX_ALPHABET_C);
+
+    for(size_t p = 0; p < wlen; p++) {
+        for(size_t l = 0; l < MAX_ALPHABET_C; l++) {
+            size_t here = at[p * MAX_ALPHABET_C + l];
+            size_t elsewhere = anywhere[l] - here;
+
+            split[p * MAX_ALPHABET_C + l] =
+                plogp(here, n) + plogp(elsewhere, n) + plogp(n - anywhere[l], n);
+            there[p * MAX_ALPHABET_C + l] = plogp(here, n) + plogp(n - here, n);
+        }
+    }
+
+    std::vector<std::pair<double, const std::string*>> scored;
+    scored.reserve(guesses.size());
+
+    for(auto &guess : guesses) {
+        double score = 0;
+        lmask_t seen = 0;
+
+        for(size_t p = 0; p < wlen; p++) {
+            size_t l = letter_index(guess[p]);
+            lmask_t bit = lmask_t(1) << l;
+
+            score += (seen & bit ? there : split)[p * MAX_ALPHABET_C + l];
+            seen |= bit;
+        }
+
+        scored.push_back({score, &guess});
+    }
+
+    std::stable_sort(scored.begin(), scored.end(), [](auto &a, auto &b) {
+        return a.first > b.first;
+    });
+
+    res.reserve(scored.size());
+    for(auto &[score, guess] : scored) res.push_back(guess);
+    return res;
+}
@@ -0,0 +1,125 @@
+#include "histengine.h"
+#include "histogram.h"
+#include "memstats.h"
+#include "trace.h"
+#include "wordtable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+
+HistEngine::HistEngine(
+    const std::list<std::string>* wl,
+    const std::list<std::string>* d,
+    const Kernels& k,
+    ProgressFn progress,
+    size_t threads,
+    Tiling tile
+) :
+    words_left(wl)
+{
+    TraceSpan span("Histogram engine", d->size());
+    const size_t wlen = k.wlen;
+    if(wlen > FCODE_MAX_LENGTH) {
+        throw std::runtime_error("Words too long for the histogram engine");
+    }
+
+    const WordTable guesses(*d, wlen);
+    const WordTable answers(*wl, wlen);
+    const size_t guess_c = guesses.size();
+
+    const Tiling t = auto_tiling(
+        tile, wlen, Histogram::footprint(wlen, answers.size())
+    );
+    const size_t blocks = (guess_c + t.guesses - 1) / t.guesses;
+
+    if(threads == 0) threads = std::thread::hardware_concurrency();
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(blocks, 1));
+
+    // Every guess only ever gets written by one thread
+    std::vector<Accumulator> acc(guess_c, Accumulator{0, 0});
+
+    std::atomic<size_t> next = 0;
+    std::mutex lock;
+    std::condition_variable changed;
+    size_t finished = 0;
+
+    std::vector<std::thread> workers;
+    for(size_t w = 0; w < threads; w++) {
+        workers.emplace_back([&]() {
+            MemoryScope scope(MEM_HIST);
+            std::vector<Histogram> hists(t.guesses, Histogram(wlen));
+
+            for(size_t b; (b = next++) < blocks; ) {
+                const size_t g0 = b * t.guesses;
+                const size_t g1 = std::min(g0 + t.guesses, guess_c);
+                TraceSpan block("Score block", g1 - g0);
+
+                fill_histograms(
+                    hists.data(), guesses.word(g0), g1 - g0, 
+                    answers, k, t.answers
+                );
+
+                // Each bucket of c words leaves c words, c times
+                for(size_t g = g0; g < g1; g++) {
+                    Histogram &hist = hists[g - g0];
+                    hist.for_each([&](fcode_t, size_t c) { acc[g].add(c, c); });
+                    hist.clear();
+                }
+
+                std::lock_guard<std::mutex> guard(lock);
+                finished += g1 - g0;
+                changed.notify_one();
+            }
+        });
+    }
+
+    // Progress gets reported from this thread only
+    try {
+        Progress p(progress, "Scoring guesses", guess_c);
+        TraceSpan wait("Wait for workers", threads);
+
+        std::unique_lock<std::mutex> guard(lock);
+        for(size_t seen = 0; seen < guess_c; ) {
+            changed.wait(guard, [&]() { return finished > seen; });
+            p.inc(finished - seen);
+            seen = finished;
+        }
+    }
+
+    // (Cancelled) stop handing out blocks, and wait for the workers
+    catch (...) {
+        next = blocks;
+        for(auto &w : workers) w.join();
+        throw;
+    }
+
+    for(auto &w : workers) w.join();
+
+    MemoryScope scope(MEM_ELIMS);
+    TraceSpan collect("Collect scores", guess_c);
+    size_t g = 0;
+    for(auto &guess : *d) elims[guess] = acc[g++];
+}
+
+
+std::vector<Suggestion> HistEngine::ranking(size_t n) const {
+    return best_of(elims, n);
+}
+
+
+std::vector<Suggestion> HistEngine::candidates() const {
+    std::vector<Suggestion> res;
+    res.reserve(words_left->size());
+
+    for(auto &word : *words_left) {
+        auto e = elims.find(word);
+        if(e != elims.end()) res.push_back({word, e->second.avg()});
+    }
+
+    return res;
+}
@@ -0,0 +1,73 @@
+#include "histogram.h"
+
+#include <algorithm>
+
+
+Histogram::Histogram(size_t wlen) {
+    if(dense_viable(wlen)) {
+        size_t size = 1;
+        for(size_t i = 0; i < wlen; i++) size *= 3;
+        dense.assign(size, 0);
+    }
+}
+
+
+bool Histogram::dense_viable(size_t wlen) {
+    size_t size = 1;
+    for(size_t i = 0; i < wlen; i++) {
+        size *= 3;
+        if(size > HIST_DENSE_MAX) return false;
+    }
+
+    return true;
+}
+
+
+size_t Histogram::footprint(size_t wlen, size_t words) {
+    if(!dense_viable(wlen)) {
+        // A hash map node, and its bucket
+        return words * (sizeof(std::pair<fcode_t, uint32_t>) + 3 * sizeof(void*));
+    }
+
+    size_t size = 1;
+    for(size_t i = 0; i < wlen; i++) size *= 3;
+    return size * sizeof(uint32_t);
+}
+
+
+void Histogram::clear() {
+    for(auto &code : touched) dense[code] = 0;
+    touched.clear();
+    sparse.clear();
+}
+
+
+size_t Histogram::buckets() const {
+    return dense.empty() ? sparse.size() : touched.size();
+}
+
+
+size_t Histogram::count(fcode_t code) const {
+    if(!dense.empty()) return dense[code];
+
+    auto c = sparse.find(code);
+    return c == sparse.end() ? 0 : c->second;
+}
+
+
+void fill_histograms(
+    Histogram* hists, const char* guesses, size_t guess_c,
+    const WordTable& answers, const Kernels& k, size_t answer_tile
+) {
+    for(size_t a0 = 0; a0 < answers.size(); a0 += answer_tile) {
+        const size_t a1 = std::min(a0 + answer_tile, answers.size());
+
+        for(size_t g = 0; g < guess_c; g++) {
+            const char* guess = guesses + g * k.wlen;
+
+            for(size_t a = a0; a < a1; a++) {
+                hists[g].add(k.feedback(guess, answers.word(a), k.wlen));
+            }
+        }
+    }
+}
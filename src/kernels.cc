@@ -0,0 +1,125 @@
+#include "kernels.h"
+#include "dictionary.h"
+
+#include <array>
+#include <utility>
+
+
+// Feedback codes are decoded this many positions at a time
+#define DECODE_CHUNK 5
+
+namespace {
+    // 3^i for every position, built at compile time
+    constexpr auto POW3 = [] {
+        std::array<fcode_t, FCODE_MAX_LENGTH + 1> res = {};
+        res[0] = 1;
+        for(size_t i = 1; i < res.size(); i++) res[i] = res[i-1] * 3;
+        return res;
+    }();
+
+    // The marks of every possible chunk of a feedback code
+    constexpr auto DECODE = [] {
+        std::array<std::array<uint8_t, DECODE_CHUNK>, POW3[DECODE_CHUNK]> res = {};
+
+        for(size_t c = 0; c < res.size(); c++) {
+            size_t code = c;
+            for(size_t i = 0; i < DECODE_CHUNK; i++) {
+                res[c][i] = code % 3;
+                code /= 3;
+            }
+        }
+        return res;
+    }();
+
+
+    // All kernels are templated on the word length L. L = 0 instantiates
+    // the generic versions, which use the runtime length n instead
+    template<size_t L>
+    void marks(const char* guess, const char* word, uint8_t* out, size_t n) {
+        const size_t len = L ? L : n;
+
+        // Letters of the word that are not matched exactly
+        uint8_t left[MAX_ALPHABET_C] = {};
+
+        for(size_t i = 0; i < len; i++) {
+            bool right = guess[i] == word[i];
+            out[i] = right ? FB_RIGHT : FB_WRONG;
+            left[letter_index(word[i])] += !right;
+        }
+
+        // Those can turn up elsewhere, from left to right
+        for(size_t i = 0; i < len; i++) {
+            uint8_t &l = left[letter_index(guess[i])];
+            if(out[i] == FB_WRONG && l) {
+                out[i] = FB_PLACE;
+                l--;
+            }
+        }
+    }
+
+
+    template<size_t L>
+    fcode_t feedback(const char* guess, const char* word, size_t n) {
+        const size_t len = L ? L : n;
+
+        uint8_t m[L ? L : MAX_WORD_LENGTH];
+        marks<L>(guess, word, m, n);
+
+        fcode_t res = 0;
+        for(size_t i = 0; i < len; i++) res += m[i] * POW3[i];
+        return res;
+    }
+
+
+    template<size_t L>
+    void decode(fcode_t code, uint8_t* out, size_t n) {
+        const size_t len = L ? L : n;
+
+        for(size_t i = 0; i < len; i += DECODE_CHUNK) {
+            auto &chunk = DECODE[code % POW3[DECODE_CHUNK]];
+            code /= POW3[DECODE_CHUNK];
+
+            for(size_t j = 0; j < DECODE_CHUNK && i + j < len; j++) {
+                out[i + j] = chunk[j];
+            }
+        }
+    }
+
+
+    template<size_t L>
+    constexpr Kernels make_kernels() {
+        return {
+            L, &feedback<L>, &marks<L>, &decode<L>
+        };
+    }
+
+    template<size_t... I>
+    constexpr auto make_table(std::index_sequence<I...>) {
+        return std::array<Kernels, sizeof...(I)>{
+            make_kernels<KERNEL_MIN_LENGTH + I>()...
+        };
+    }
+
+    constexpr auto SPECIALIZED = make_table(
+        std::make_index_sequence<KERNEL_MAX_LENGTH - KERNEL_MIN_LENGTH + 1>()
+    );
+    constexpr auto GENERIC = make_kernels<0>();
+}
+
+
+Kernels kernels(size_t wlen) {
+    if(wlen >= KERNEL_MIN_LENGTH && wlen <= KERNEL_MAX_LENGTH) {
+        return SPECIALIZED[wlen - KERNEL_MIN_LENGTH];
+    }
+
+    Kernels res = GENERIC;
+    res.wlen = wlen;
+    return res;
+}
+
+
+fcode_t encode(const uint8_t* marks, size_t wlen) {
+    fcode_t res = 0;
+    for(size_t i = 0; i < wlen; i++) res += marks[i] * POW3[i];
+    return res;
+}
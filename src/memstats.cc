@@ -0,0 +1,205 @@
+#include "memstats.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <new>
+#include <unordered_map>
+
+#include <sys/resource.h>
+
+
+namespace {
+    // The bookkeeping below allocates with malloc directly,
+    // so it does not end up counting itself
+    template<class T>
+    struct MallocAllocator {
+        using value_type = T;
+
+        MallocAllocator() = default;
+        template<class U> MallocAllocator(const MallocAllocator<U>&) {}
+
+        T* allocate(size_t n) {
+            if(void* p = std::malloc(n * sizeof(T))) return static_cast<T*>(p);
+            throw std::bad_alloc();
+        }
+
+        void deallocate(T* p, size_t) { std::free(p); }
+
+        bool operator==(const MallocAllocator&) const { return true; }
+    };
+
+    struct Counter {
+        size_t allocs = 0;
+        size_t bytes = 0;
+        size_t live = 0;
+        size_t peak = 0;
+
+        void add(size_t n) {
+            allocs++;
+            bytes += n;
+            live += n;
+            peak = std::max(peak, live);
+        }
+    };
+
+    // What a live allocation asked for, and who made it
+    struct Allocation {
+        size_t bytes;
+        int subsystem;
+    };
+
+    const char* SUBSYSTEM_NAMES[MEM_SUBSYSTEM_C] = {
+        "other", "words", "tree nodes", "letter evaluations",
+        "histograms", "eliminations", "scores"
+    };
+
+    std::atomic<bool> tracking = false;
+    size_t trackers = 0;
+    std::mutex lock;
+
+    thread_local int subsystem = MEM_OTHER;
+    // Set while we hold the lock, allocations made then are our own
+    thread_local bool inside = false;
+
+    std::unordered_map<
+        void*, Allocation, std::hash<void*>, std::equal_to<void*>,
+        MallocAllocator<std::pair<void* const, Allocation>>
+    > live;
+
+    // All of them together, per subsystem and per phase. The live
+    // bytes of a phase are not kept, its peak is the one of the total
+    Counter total;
+    Counter subsystems[MEM_SUBSYSTEM_C];
+    std::vector<std::pair<std::string, Counter>> phases;
+    size_t phase = 0;
+
+
+    void allocated(void* p, size_t n) {
+        if(inside) return;
+        std::lock_guard<std::mutex> guard(lock);
+        if(!tracking) return;
+
+        live[p] = {n, subsystem};
+        total.add(n);
+        subsystems[subsystem].add(n);
+
+        Counter &c = phases[phase].second;
+        c.allocs++;
+        c.bytes += n;
+        c.peak = std::max(c.peak, total.live);
+    }
+
+
+    void freed(void* p) {
+        if(inside) return;
+        std::lock_guard<std::mutex> guard(lock);
+
+        // (Allocations from before the tracking started are not in there)
+        auto a = live.find(p);
+        if(a == live.end()) return;
+
+        total.live -= a->second.bytes;
+        subsystems[a->second.subsystem].live -= a->second.bytes;
+        live.erase(a);
+    }
+}
+
+
+void memory_allocated(void* p, size_t n) {
+    if(tracking.load(std::memory_order_relaxed)) allocated(p, n);
+}
+
+
+void memory_freed(void* p) {
+    if(p && tracking.load(std::memory_order_relaxed)) freed(p);
+}
+
+
+MemoryTracker::MemoryTracker() {
+    std::lock_guard<std::mutex> guard(lock);
+    inside = true;
+
+    if(trackers++ == 0) {
+        live.clear();
+        total = {};
+        for(auto &c : subsystems) c = {};
+        phases.assign(1, {"Setup", {}});
+        phase = 0;
+        tracking = true;
+    }
+
+    inside = false;
+}
+
+
+MemoryTracker::~MemoryTracker() {
+    std::lock_guard<std::mutex> guard(lock);
+    if(--trackers > 0) return;
+
+    // The bookkeeping can be about as big as what it tracked
+    tracking = false;
+    decltype(live)().swap(live);
+}
+
+
+MemoryReport MemoryTracker::report() const {
+    MemoryReport res = {};
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        inside = true;
+
+        for(auto &[name, c] : phases) {
+            res.phases.push_back({name, c.allocs, c.bytes, c.peak});
+        }
+
+        for(size_t s = 0; s < MEM_SUBSYSTEM_C; s++) {
+            const Counter &c = subsystems[s];
+            if(c.allocs) {
+                res.subsystems.push_back(
+                    {SUBSYSTEM_NAMES[s], c.allocs, c.bytes, c.peak}
+                );
+            }
+        }
+
+        inside = false;
+    }
+
+    // (In kilobytes, on Linux)
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    res.peak_rss = (size_t) usage.ru_maxrss << 10;
+
+    return res;
+}
+
+
+MemoryScope::MemoryScope(int s) : previous(subsystem) {
+    subsystem = s;
+}
+
+
+MemoryScope::~MemoryScope() {
+    subsystem = previous;
+}
+
+
+void memory_phase(const std::string& name) {
+    if(!tracking.load(std::memory_order_relaxed)) return;
+
+    std::lock_guard<std::mutex> guard(lock);
+    if(!tracking) return;
+    inside = true;
+
+    for(phase = 0; phase < phases.size(); phase++) {
+        if(phases[phase].first == name) break;
+    }
+    if(phase == phases.size()) phases.push_back({name, {}});
+
+    Counter &c = phases[phase].second;
+    c.peak = std::max(c.peak, total.live);
+
+    inside = false;
+}
@@ -0,0 +1,171 @@
+#include "multisolver.h"
+#include "histogram.h"
+#include "trace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+
+
+MultiSolver::MultiSolver(std::shared_ptr<const Dictionary> d, size_t boards) :
+    dict(d), wlen(d->length()), kern(kernels(wlen)),
+    is_solved(boards, false)
+{
+    if(boards == 0) throw std::runtime_error("Need at least one board");
+    if(wlen > FCODE_MAX_LENGTH) throw std::runtime_error("Words too long");
+
+    // We start with all words still in the running, on every board
+    any_board.resize(dict->size());
+    for(size_t i = 0; i < dict->size(); i++) any_board[i] = i;
+    candidates.assign(boards, any_board);
+}
+
+
+void MultiSolver::fill_row(const char* g, std::vector<fcode_t>& row) const {
+    for(auto &w : any_board) {
+        row[w] = kern.feedback(g, dict->word(w).data(), wlen);
+    }
+}
+
+
+void MultiSolver::update(
+    const std::string& word, 
+    const std::vector<std::string>& marks
+) {
+    const std::string guess = dict->alphabet().encode(word);
+    if(guess.length() != wlen) {
+        throw std::runtime_error("Word has the wrong length");
+    }
+    if(marks.size() != boards()) {
+        throw std::runtime_error("Need one set of marks per board");
+    }
+
+    // Work out all codes before touching any board
+    std::vector<fcode_t> codes;
+    std::vector<uint8_t> m(wlen);
+
+    for(size_t b = 0; b < boards(); b++) {
+        // (Anything goes for solved boards, they are skipped below)
+        const std::string& board_marks = marks[b];
+        if(is_solved[b]) { codes.push_back(0); continue; }
+
+        if(board_marks.length() != wlen) {
+            throw std::runtime_error("Word and marks dont have equal length");
+        }
+
+        for(size_t i = 0; i < wlen; i++) {
+            switch(board_marks[i]) {
+                case 'v': m[i] = FB_RIGHT; break;
+                case 'c': m[i] = FB_PLACE; break;
+                case 'x': m[i] = FB_WRONG; break;
+                default: throw std::runtime_error("Invalid mark. Use [xcv]");
+            }
+        }
+        codes.push_back(encode(m.data(), wlen));
+    }
+
+    std::fill(m.begin(), m.end(), FB_RIGHT);
+    const fcode_t all_right = encode(m.data(), wlen);
+
+    // The feedback of the guess is shared between all boards
+    std::vector<fcode_t> row(dict->size());
+    fill_row(guess.data(), row);
+
+    for(size_t b = 0; b < boards(); b++) {
+        if(is_solved[b]) continue;
+
+        if(codes[b] == all_right) {
+            is_solved[b] = true;
+            candidates[b].clear();
+            continue;
+        }
+
+        std::erase_if(candidates[b], 
+            [&](uint32_t w) { return row[w] != codes[b]; }
+        );
+    }
+
+    // Only words of unsolved boards matter from now on
+    std::vector<uint32_t> merged;
+    any_board.clear();
+    for(auto &c : candidates) {
+        merged.clear();
+        std::set_union(
+            any_board.begin(), any_board.end(), c.begin(), c.end(),
+            std::back_inserter(merged)
+        );
+        any_board.swap(merged);
+    }
+}
+
+
+bool MultiSolver::done() const {
+    for(size_t b = 0; b < boards(); b++) {
+        if(!is_solved[b] && !candidates[b].empty()) return false;
+    }
+
+    return true;
+}
+
+
+std::vector<std::string> MultiSolver::remaining(size_t board) const {
+    std::vector<std::string> res;
+    for(auto &w : candidates[board]) {
+        res.push_back(dict->alphabet().decode(dict->word(w)));
+    }
+    return res;
+}
+
+
+SolveResult MultiSolver::calculate_best_guess(const SolveOptions& opts) const {
+    TraceSpan span("Score guesses on all boards", dict->size());
+    auto start = std::chrono::steady_clock::now();
+    SolveResult res = {};
+
+    std::vector<uint8_t> m(wlen, FB_RIGHT);
+    const fcode_t all_right = encode(m.data(), wlen);
+
+    Progress progress(opts.progress, "Scoring guesses on all boards", dict->size());
+
+    std::vector<fcode_t> row(dict->size());
+    Histogram hist(wlen);
+    std::vector<std::pair<double, uint32_t>> scores;
+    scores.reserve(dict->size());
+
+    for(size_t g = 0; g < dict->size(); g++) {
+        // One pass of evaluations, for all boards
+        fill_row(dict->word(g).data(), row);
+
+        double score = 0;
+        for(size_t b = 0; b < boards(); b++) {
+            if(is_solved[b] || candidates[b].empty()) continue;
+
+            hist.clear();
+            for(auto &w : candidates[b]) hist.add(row[w]);
+
+            size_t sum = 0;
+            hist.for_each([&](fcode_t, size_t c) { sum += c * c; });
+
+            // If the guess is the answer, that board is done
+            sum -= hist.count(all_right);
+            score += (double) sum / candidates[b].size();
+        }
+
+        scores.push_back({score, g});
+        progress.inc();
+    }
+
+    size_t n = std::min(opts.top_n, scores.size());
+    std::partial_sort(scores.begin(), scores.begin() + n, scores.end());
+
+    for(size_t i = 0; i < n; i++) {
+        res.guesses.push_back({
+            dict->alphabet().decode(dict->word(scores[i].second)), 
+            scores[i].first
+        });
+    }
+
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    res.seconds = took.count();
+    return res;
+}
@@ -0,0 +1,35 @@
+#include "progress.h"
+#include "memstats.h"
+
+
+Progress::Progress(const ProgressFn& fn, std::string phase, size_t total) :
+    fn(fn), phase(phase), total(total), cur(0), next(0)
+{
+    memory_phase(phase);
+    report();
+}
+
+
+void Progress::inc(const size_t val) {
+    cur += val;
+    if(cur >= next || cur == total) report();
+}
+
+
+void Progress::inc() { inc(1); }
+
+
+void Progress::report() {
+    next = cur + total / PROGRESS_STEPS + 1;
+    if(fn) fn(phase, cur, total);
+}
+
+
+ProgressFn cancellable(ProgressFn fn, const std::atomic<bool>* cancel) {
+    if(!cancel) return fn;
+
+    return [fn, cancel](const std::string& phase, size_t cur, size_t total) {
+        if(*cancel) throw Cancelled();
+        if(fn) fn(phase, cur, total);
+    };
+}
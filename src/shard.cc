@@ -0,0 +1,134 @@
+#include "shard.h"
+#include "solver.h"
+
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include <netdb.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// Pending connections before new ones get refused
+#define SHARD_BACKLOG 64
+
+
+std::vector<std::string> ShardJob::to_args() const {
+    std::vector<std::string> res = {
+        dictionary, std::to_string(wlen), 
+        std::to_string(index), std::to_string(count)
+    };
+    res.insert(res.end(), played.begin(), played.end());
+
+    return res;
+}
+
+
+ShardJob ShardJob::from_args(const std::vector<std::string>& args) {
+    if(args.size() < 4 || args.size() % 2 != 0) {
+        throw std::runtime_error(
+            "Expected: dictionary wlen index count [word marks ...]"
+        );
+    }
+
+    ShardJob res;
+    res.dictionary = args[0];
+
+    try {
+        res.wlen = std::stoul(args[1]);
+        res.index = std::stoul(args[2]);
+        res.count = std::stoul(args[3]);
+    }
+    catch (const std::logic_error&) { 
+        throw std::runtime_error("Invalid number in shard job"); 
+    }
+
+    if(res.count == 0 || res.index >= res.count) {
+        throw std::runtime_error("Invalid shard index");
+    }
+
+    res.played.assign(args.begin() + 4, args.end());
+    return res;
+}
+
+
+void run_shard(const ShardJob& job, std::ostream& out) {
+    WordleSolver solver(job.dictionary, job.wlen);
+
+    for(size_t i = 0; i < job.played.size(); i += 2) {
+        solver.update(job.played[i], job.played[i+1]);
+    }
+
+    write_accumulators(out, solver.accumulate(job.index, job.count));
+    out.flush();
+}
+
+
+namespace {
+    // Serves one client of serve_shards
+    void serve_shard_client(int fd) {
+        std::string line;
+        char c;
+
+        while(recv(fd, &c, 1, 0) == 1 && c != '\n') line += c;
+
+        std::ostringstream out;
+        try {
+            std::istringstream words(line);
+            std::vector<std::string> args;
+            for(std::string a; words >> a; ) args.push_back(a);
+
+            run_shard(ShardJob::from_args(args), out);
+        }
+        catch (const std::runtime_error& e) {
+            out << "ERR " << e.what() << "\n";
+        }
+
+        std::string res = out.str();
+        for(size_t sent = 0; sent < res.size(); ) {
+            ssize_t n = send(
+                fd, res.data() + sent, res.size() - sent, MSG_NOSIGNAL
+            );
+            if(n <= 0) break;
+            sent += n;
+        }
+
+        close(fd);
+    }
+}
+
+
+void serve_shards(const std::string& host, uint16_t port) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_flags = AI_PASSIVE;
+
+    addrinfo* addr;
+    if(getaddrinfo(
+        host.c_str(), std::to_string(port).c_str(), &hints, &addr
+    ) != 0) {
+        throw std::runtime_error("Could not resolve " + host);
+    }
+
+    int server = socket(addr->ai_family, addr->ai_socktype, addr->ai_protocol);
+    int yes = 1;
+    setsockopt(server, SOL_SOCKET, SO_REUSEADDR, &yes, sizeof(yes));
+
+    bool ok = server >= 0
+        && bind(server, addr->ai_addr, addr->ai_addrlen) == 0
+        && listen(server, SHARD_BACKLOG) == 0;
+    freeaddrinfo(addr);
+
+    if(!ok) {
+        if(server >= 0) close(server);
+        throw std::runtime_error("Could not listen on port " + std::to_string(port));
+    }
+
+    while(true) {
+        int client = accept(server, nullptr, nullptr);
+        if(client < 0) continue;
+
+        std::thread(serve_shard_client, client).detach();
+    }
+}
@@ -1,87 +1,105 @@
 #include "solver.h"
 #include "evaltree.h"
+#include "cache.h"
+#include "checkpoint.h"
+#include "constraint.h"
+#include "histengine.h"
+#include "heuristic.h"
+#include "histogram.h"
+#include "trace.h"
 
 #include <algorithm>
-#include <cctype>
-#include <fstream>
-#include <iostream>
-#include <iterator>
+#include <chrono>
+#include <sstream>
+#include <unordered_set>
 
 
-// Word guess: collection of letter guesses
-WordleSolver::WordleSolver(std::string filename, size_t l) : wlen(l) {
-    // Read in a dictionary file
-    read_dict(filename, wlen);
-    // Set the guess to nothing
-    guessed = std::string(wlen, '.');
-}
-
+namespace {
+    // FNV-1a, to tell different lists of words apart. Goes on from 
+    // the hash of something else, if given
+    uint64_t hash_words(
+        const std::list<std::string>& words,
+        uint64_t res = 14695981039346656037ull
+    ) {
+        for(auto &word : words) {
+            for(auto &c : word) {
+                res = (res ^ (uint8_t) c) * 1099511628211ull;
+            }
+            res = (res ^ ' ') * 1099511628211ull;
+        }
 
-// Reads a sorted dictionary file to use for suggestion
-void WordleSolver::read_dict(std::string filename, size_t wlen) {
-    dict = std::make_unique<std::list<std::string>>();
-    std::ifstream dict_file(filename);
+        return res;
+    }
 
-    if(dict_file.is_open()){
-        std::copy_if(
-            std::istream_iterator<std::string>(dict_file),
-            std::istream_iterator<std::string>(), // Empty itertor is OEF
-            std::back_inserter(*dict),
 
-            // Only copies words of length wlen
-            [wlen](const std::string &s) { 
-                return s.length() == wlen 
-                && std::all_of(
-                    s.begin(), s.end(), 
-                    [](const char c){ return std::isalpha(c); }
-                ); 
-            }
-        );
+    // Turns the inner form of the words back into UTF-8
+    void decode(std::vector<Suggestion>& s, const Alphabet& alphabet) {
+        for(auto &[word, score] : s) word = alphabet.decode(word);
     }
+}
 
-    else { 
-        throw std::runtime_error("Error reading file."); 
-    }
-    
-    // Use only lower case letters in the rest of the program
-    for(auto &word : *dict) {
-        for(auto &i : word) {
-            i = std::tolower(i);
-        }
+
+// Word guess: collection of letter guesses
+WordleSolver::WordleSolver(std::string filename, size_t l) : 
+    // Text or compiled, the Dictionary figures it out
+    WordleSolver(Dictionary::load(filename, l)) 
+{}
+
+
+WordleSolver::WordleSolver(std::shared_ptr<const Dictionary> d) : 
+    dictionary(d), wlen(d->length()), kern(kernels(wlen)),
+    cache(std::make_shared<ResultCache>(RESULT_CACHE_C))
+{
+    auto words = std::make_shared<std::list<std::string>>();
+    for(size_t i = 0; i < dictionary->size(); i++) {
+        words->emplace_back(dictionary->word(i));
     }
+    dict = words;
+    // The words are in inner form, which only means something along 
+    // with the letters of the alphabet
+    dict_hash = hash_words(*dict, hash_words({dictionary->alphabet().utf8()}));
 
     // We start with all words still in the running
-    words_left = std::make_unique<std::list<std::string>>(*dict);
+    words_left = dict;
+    left = WordSet::all(dict->size());
+    // Set the guess to nothing
+    guessed = std::string(wlen, '.');
 }
 
 
+// A copy of the current game, the dictionary and cache are shared
+WordleSolver::WordleSolver(const WordleSolver& s) :
+    dictionary(s.dictionary), dict(s.dict), words_left(s.words_left),
+    left(s.left), dict_hash(s.dict_hash), guessed(s.guessed), wlen(s.wlen),
+    kern(s.kern), cache(s.cache)
+{}
 
-// Check if done and print something if so
-bool WordleSolver::done() const {
-    switch (words_left->size()) {
-        case 0: 
-            std::cout << "Word not in dictionary.\n";
-            return true;
-
-        case 1:
-            std::cout << "The word is " << words_left->front() << "\n";
-            return true;
 
-        default: return false;
-    }
+// Check if done
+bool WordleSolver::done() const {
+    return words_left->size() <= 1;
 }
 
 
 // TODO: see if we can do something about the code 
 // duplicaiton with evaluate(...) in evaltree.cc
 void WordleSolver::update(
-    const std::string& guess, 
+    const std::string& word, 
     const std::string& marks
 ) {
+    TraceSpan span("Update", words_left->size());
+    const std::string guess = dictionary->alphabet().encode(word);
     std::vector<std::unique_ptr<const LetterEval>> result;
     std::map<char,int> places;
     for(auto &c : guessed) { places[c]++; }
 
+    // Only commit to the new letters once the marks turn out valid
+    std::string now_guessed = guessed;
+
+    if(guess.length() != wlen) {
+        throw std::runtime_error("Word has the wrong length");
+    }
+
     if(guess.length() != marks.length()) {
         throw std::runtime_error("Word and marks dont have equal length");
     }
@@ -91,7 +109,7 @@ void WordleSolver::update(
         if(marks[i] == 'v') {
             result.push_back(std::make_unique<EvalRight>(i, guess[i]));
             places[guess[i]]++;
-            guessed[i] = guess[i];
+            now_guessed[i] = guess[i];
         }
     }
     
@@ -113,16 +131,447 @@ void WordleSolver::update(
     if(result.size() != wlen)
         throw std::runtime_error("Invalid mark. Use [xcv]");
 
+    guessed = now_guessed;
+
+    Constraint c;
+    for(auto &letter : result) c.add(*letter);
+
+    // Only words with the right letters in place can fit, so start from
+    // the words with those (when that is fewer than are left)
+    WordSet fits = left;
     for(auto &letter : result) {
-        letter->filter(words_left.get());
+        if(letter->type != LGUESS_RIGHT) continue;
+
+        auto with = dictionary->with_letter_at(letter->idx, letter->letter);
+        if(with.size() < fits.size()) fits &= WordSet(with);
+    }
+
+    fits.filter([&](uint32_t w) {
+        return c.matches(
+            dictionary->word(w).data(), dictionary->counts(w),
+            dictionary->mask(w)
+        );
+    });
+
+    auto words = std::make_shared<std::list<std::string>>();
+    fits.for_each([&](uint32_t w) {
+        words->emplace_back(dictionary->word(w));
+    });
+
+    left = std::move(fits);
+    words_left = words;
+}
+
+
+SolveResult WordleSolver::calculate_best_guess(
+    const SolveOptions& options
+) const {
+    TraceSpan span("Calculate best guess", words_left->size());
+    auto start = std::chrono::steady_clock::now();
+    SolveResult res = {};
+
+    // Nothing to rank
+    if(words_left->empty()) return res;
+
+    // Worked out before (possibly ahead of time, see speculate)
+    const std::string key = cache_key(options);
+    if(auto hit = cache->find(key)) {
+        std::chrono::duration<double> took = 
+            std::chrono::steady_clock::now() - start;
+        hit->seconds = took.count();
+        return *hit;
+    }
+
+    std::unique_ptr<MemoryTracker> tracker;
+    if(options.memory_stats) tracker = std::make_unique<MemoryTracker>();
+
+    // The compute loops check for cancellation whenever they report
+    SolveOptions opts = options;
+    opts.progress = cancellable(opts.progress, opts.cancel);
+
+    // Only the most promising guesses get scored exactly
+    const std::list<std::string>* guesses = dict.get();
+    std::vector<const std::string*> ranked;
+    std::list<std::string> shortlist;
+    std::unordered_set<std::string> picked;
+
+    const bool trimmed = opts.shortlist && opts.shortlist < dict->size();
+    if(trimmed || opts.deadline > 0) {
+        ranked = heuristic_ranking(*dict, *words_left);
+    }
+
+    if(trimmed) {
+        for(size_t i = 0; i < opts.shortlist; i++) picked.insert(*ranked[i]);
+        if(words_left->size() <= opts.shortlist) {
+            picked.insert(words_left->begin(), words_left->end());
+        }
+
+        // In dictionary order, like the full list
+        for(auto &guess : *dict) {
+            if(picked.count(guess)) shortlist.push_back(guess);
+        }
+
+        guesses = &shortlist;
+    }
+
+    size_t chunk = chunk_size(opts);
+    if(opts.deadline > 0) {
+        // The shortlist, in the order of the heuristic
+        std::vector<const std::string*> order;
+        for(auto guess : ranked) {
+            if(!trimmed || picked.count(*guess)) order.push_back(guess);
+        }
+
+        res = anytime(opts, order, start);
+    }
+
+    else if(!opts.checkpoint.empty() || chunk < guesses->size()) {
+        res = chunked(opts, chunk, *guesses);
+    }
+
+    else if(histograms(opts)) {
+        HistEngine engine(
+            words_left.get(), guesses, kern, opts.progress,
+            opts.threads, opts.tiling
+        );
+        res.guesses = engine.ranking(opts.top_n);
+        res.candidates = engine.candidates();
+    }
+
+    else {
+        EvalTree elim_solver(
+            words_left.get(), guesses, guessed, kern, opts.progress,
+            opts.tiling
+        );
+        res.guesses = elim_solver.ranking(opts.top_n);
+        res.candidates = elim_solver.candidates();
+    }
+
+    decode(res.guesses, dictionary->alphabet());
+    decode(res.candidates, dictionary->alphabet());
+
+    std::chrono::duration<double> took = std::chrono::steady_clock::now() - start;
+    res.seconds = took.count();
+
+    // (Not part of the time it took)
+    if(opts.audit_shortlist && trimmed) {
+        res.audit = audit(options, ranked, shortlist);
+    }
+
+    // Another try might get further
+    if(!res.partial) cache->store(key, res);
+    if(tracker) res.memory = tracker->report();
+    return res;
+}
+
+
+void WordleSolver::speculate(
+    const SolveResult& res, const SolveOptions& opts, size_t n
+) const {
+    if(res.guesses.empty() || wlen > FCODE_MAX_LENGTH) return;
+    TraceSpan span("Speculate", n);
+    const std::string& word = res.guesses.front().word;
+    const std::string guess = dictionary->alphabet().encode(word);
+
+    // How many words give each feedback on the guess
+    Histogram hist(wlen);
+    for(auto &word : *words_left) {
+        hist.add(kern.feedback(guess.data(), word.data(), wlen));
+    }
+
+    std::vector<std::pair<size_t, fcode_t>> buckets;
+    hist.for_each([&](fcode_t code, size_t c) { buckets.push_back({c, code}); });
+    std::sort(buckets.rbegin(), buckets.rend());
+
+    // Quietly, and without touching the checkpoint of this round
+    SolveOptions next = opts;
+    next.progress = nullptr;
+    next.checkpoint.clear();
+    // Partial results would not get cached anyway
+    next.deadline = 0;
+
+    uint8_t marks[MAX_WORD_LENGTH];
+    for(auto &[c, code] : buckets) {
+        if(n == 0 || (opts.cancel && *opts.cancel)) break;
+        // Nothing left to suggest
+        if(c <= 1) break;
+
+        // The marks a user would type, indexed by FB_*
+        kern.decode(code, marks, wlen);
+        std::string m(wlen, ' ');
+        for(size_t i = 0; i < wlen; i++) m[i] = "xcv"[marks[i]];
+
+        WordleSolver game(*this);
+        game.update(word, m);
+        game.calculate_best_guess(next);
+        n--;
+    }
+}
+
+
+ShortlistAudit WordleSolver::audit(
+    const SolveOptions& opts,
+    const std::vector<const std::string*>& ranked,
+    const std::list<std::string>& shortlist
+) const {
+    TraceSpan span("Audit shortlist", ranked.size());
+
+    // The same calculation, for all guesses (and cached like one)
+    SolveOptions all = opts;
+    all.shortlist = 0;
+    all.audit_shortlist = false;
+    all.memory_stats = false;
+    all.deadline = 0;
+
+    SolveResult exact = calculate_best_guess(all);
+    if(exact.guesses.empty()) return {};
+
+    ShortlistAudit res;
+    res.done = true;
+    res.best = exact.guesses.front().word;
+    res.score = exact.guesses.front().score;
+
+    const std::string best = dictionary->alphabet().encode(res.best);
+    while(res.rank < ranked.size() && *ranked[res.rank] != best) res.rank++;
+    res.missed = 
+        std::find(shortlist.begin(), shortlist.end(), best) == shortlist.end();
+
+    return res;
+}
+
+
+SolveResult WordleSolver::chunked(
+    const SolveOptions& opts, size_t chunk_c,
+    const std::list<std::string>& guesses
+) const {
+    std::unique_ptr<Checkpoint> checkpoint;
+    std::map<std::string, Accumulator> done;
+
+    if(!opts.checkpoint.empty()) {
+        checkpoint = std::make_unique<Checkpoint>(
+            opts.checkpoint, checkpoint_key(opts), opts.checkpoint_interval
+        );
+
+        // Guesses from an earlier (interrupted) run are done already
+        done = checkpoint->load();
+    }
+
+    Progress progress(opts.progress, "Calculating in chunks", guesses.size());
+    // The chunks themselves do not report, but can still get cancelled
+    ProgressFn inner = cancellable(nullptr, opts.cancel);
+
+    std::list<std::string> chunk;
+    auto flush = [&]() {
+        if(chunk.empty()) return;
+
+        score_chunk(opts, chunk, inner, done);
+        progress.inc(chunk.size());
+        chunk.clear();
+        if(checkpoint) checkpoint->update(done);
+    };
+
+    for(auto &guess : guesses) {
+        if(done.count(guess)) { progress.inc(); continue; }
+
+        chunk.push_back(guess);
+        if(chunk.size() == chunk_c) flush();
+    }
+
+    flush();
+    if(checkpoint) checkpoint->update(done, true);
+
+    SolveResult res = {};
+    res.guesses = best_of(done, opts.top_n);
+
+    for(auto &word : *words_left) {
+        auto a = done.find(word);
+        if(a != done.end()) res.candidates.push_back({word, a->second.avg()});
+    }
+
+    return res;
+}
+
+
+SolveResult WordleSolver::anytime(
+    const SolveOptions& opts,
+    const std::vector<const std::string*>& ranked,
+    std::chrono::steady_clock::time_point start
+) const {
+    using Clock = std::chrono::steady_clock;
+    const auto until = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(opts.deadline)
+    );
+
+    std::map<std::string, Accumulator> done;
+    Progress progress(
+        opts.progress, "Calculating until the deadline", ranked.size()
+    );
+
+    // Chunks give up once the time is up, except for the first one
+    bool first = true;
+    ProgressFn inner = [&](const std::string&, size_t, size_t) {
+        if(opts.cancel && *opts.cancel) throw Cancelled();
+        if(!first && Clock::now() >= until) throw Cancelled();
+    };
+
+    // (Within the memory limit, if there is one)
+    const size_t most = std::max<size_t>(chunk_size(opts), 1);
+    size_t chunk_c = std::min<size_t>(DEADLINE_CHUNK, most);
+    auto next = ranked.begin();
+
+    while(next != ranked.end() && (first || Clock::now() < until)) {
+        std::list<std::string> chunk;
+        for(; next != ranked.end() && chunk.size() < chunk_c; next++) {
+            chunk.push_back(**next);
+        }
+
+        // The deadline, unless it was a real cancel
+        try { score_chunk(opts, chunk, inner, done); }
+
+        catch (const Cancelled&) {
+            if(opts.cancel && *opts.cancel) throw;
+            break;
+        }
+
+        progress.inc(chunk.size());
+        first = false;
+        chunk_c = std::min(chunk_c * 2, most);
+    }
+
+    SolveResult res = {};
+    res.guesses = best_of(done, opts.top_n);
+    res.partial = done.size() < ranked.size();
+    res.scored = done.size();
+
+    for(auto &word : *words_left) {
+        auto a = done.find(word);
+        if(a != done.end()) res.candidates.push_back({word, a->second.avg()});
+    }
+
+    return res;
+}
+
+
+void WordleSolver::score_chunk(
+    const SolveOptions& opts, const std::list<std::string>& chunk,
+    const ProgressFn& progress, std::map<std::string, Accumulator>& done
+) const {
+    TraceSpan span("Chunk", chunk.size());
+
+    if(histograms(opts)) {
+        HistEngine engine(
+            words_left.get(), &chunk, kern, progress,
+            opts.threads, opts.tiling
+        );
+        for(auto &[guess, a] : engine.accumulators()) done[guess] = a;
+    }
+
+    else {
+        EvalTree elim_solver(
+            words_left.get(), &chunk, guessed, kern, progress, opts.tiling
+        );
+        for(auto &[guess, a] : elim_solver.accumulators()) done[guess] = a;
+    }
+}
+
+
+bool WordleSolver::histograms(const SolveOptions& opts) const {
+    return opts.engine == ENGINE_HIST && wlen <= FCODE_MAX_LENGTH;
+}
+
+
+size_t WordleSolver::chunk_size(const SolveOptions& opts) const {
+    size_t res = opts.checkpoint.empty() ? dict->size() : CHECKPOINT_CHUNK;
+    // (Histograms hardly take any memory)
+    if(opts.memory_limit == 0 || histograms(opts)) return res;
+
+    // The estimate grows linearly with the amount of guesses
+    size_t answers = words_left->size();
+    size_t base = EvalTree::footprint(0, answers, wlen, opts.tiling);
+    size_t per_guess = 
+        EvalTree::footprint(1, answers, wlen, opts.tiling) - base;
+
+    if(base + per_guess > opts.memory_limit) {
+        throw std::runtime_error(
+            "Memory limit too low, need at least " 
+            + std::to_string(((base + per_guess) >> 20) + 1) + " MB"
+        );
+    }
+
+    return std::min(res, (opts.memory_limit - base) / per_guess);
+}
+
+
+std::string WordleSolver::checkpoint_key(const SolveOptions& opts) const {
+    // (The scores of the two engines do not mix)
+    return round_key() 
+        + " " + std::to_string(histograms(opts) ? ENGINE_HIST : ENGINE_TREE);
+}
+
+
+std::string WordleSolver::cache_key(const SolveOptions& opts) const {
+    return checkpoint_key(opts)
+        + " " + std::to_string(opts.top_n)
+        + " " + std::to_string(opts.shortlist)
+        + " " + std::to_string(opts.audit_shortlist);
+}
+
+
+std::string WordleSolver::round_key() const {
+    std::ostringstream res;
+    res << wlen << " " << guessed 
+        << " " << dict->size() << " " << dict_hash
+        << " " << words_left->size() << " " 
+        << (words_left == dict ? dict_hash : hash_words(*words_left));
+
+    return res.str();
+}
+
+
+std::map<std::string, Accumulator> WordleSolver::accumulate(
+    size_t index, size_t count, const ProgressFn& progress
+) const {
+    // The guesses of this shard are a contiguous slice of the dictionary,
+    // so neighbouring guesses can still share their paths in the tree
+    size_t from = index * dict->size() / count;
+    size_t to = (index + 1) * dict->size() / count;
+
+    std::list<std::string> guesses(
+        std::next(dict->begin(), from), std::next(dict->begin(), to)
+    );
+    if(guesses.empty() || words_left->empty()) return {};
+
+    EvalTree elim_solver(words_left.get(), &guesses, guessed, kern, progress);
+
+    // Other processes may have their own copy of the dictionary
+    std::map<std::string, Accumulator> res;
+    for(auto &[guess, a] : elim_solver.accumulators()) {
+        res[dictionary->alphabet().decode(guess)] = a;
+    }
+
+    return res;
+}
+
+
+std::vector<std::string> WordleSolver::remaining() const {
+    std::vector<std::string> res;
+    res.reserve(words_left->size());
+
+    for(auto &word : *words_left) {
+        res.push_back(dictionary->alphabet().decode(word));
     }
+
+    return res;
 }
 
 
-void WordleSolver::calculate_best_guess() const {
-    EvalTree elim_solver(words_left.get(), dict.get(), guessed);
+std::string WordleSolver::known() const {
+    return dictionary->alphabet().decode(guessed);
+}
+
 
-    elim_solver.best_guesses();
-    elim_solver.show_remaining();
+bool WordleSolver::first_round() const {
+    return words_left->size() == dict->size()
+        && guessed == std::string(wlen, '.');
 }
 
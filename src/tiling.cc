@@ -0,0 +1,29 @@
+#include "tiling.h"
+
+#include <algorithm>
+#include <unistd.h>
+
+
+namespace {
+    size_t cache_size(int name, size_t fallback) {
+        long res = sysconf(name);
+        return res > 0 ? res : fallback;
+    }
+}
+
+
+Tiling auto_tiling(Tiling t, size_t wlen, size_t hist_bytes) {
+    // Half of each cache, the other half is for everything else
+    static const size_t l1 = cache_size(_SC_LEVEL1_DCACHE_SIZE, TILE_L1_DEFAULT) / 2;
+    static const size_t l2 = cache_size(_SC_LEVEL2_CACHE_SIZE, TILE_L2_DEFAULT) / 2;
+
+    if(t.answers == 0) t.answers = std::max<size_t>(1, l1 / wlen);
+
+    if(t.guesses == 0) {
+        t.guesses = std::clamp<size_t>(
+            l2 / std::max<size_t>(1, hist_bytes), 1, TILE_MAX_GUESSES
+        );
+    }
+
+    return t;
+}
@@ -0,0 +1,93 @@
+#include "trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <stdexcept>
+
+#include <unistd.h>
+
+
+namespace {
+    using Clock = std::chrono::steady_clock;
+
+    std::atomic<bool> tracing = false;
+    std::mutex lock;
+    std::ofstream out;
+    Clock::time_point epoch;
+
+    // Small numbers for the threads, in the order they first trace
+    std::atomic<uint32_t> next_tid = 1;
+    thread_local uint32_t tid = 0;
+    // Spans of this thread that have not ended yet
+    thread_local size_t depth = 0;
+
+    int64_t now() {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+            Clock::now() - epoch
+        ).count();
+    }
+
+    // Writes what a span looked like, with the lock held
+    void write_span(const char* name, size_t work, int64_t start, int64_t end) {
+        out << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":" << getpid()
+            << ",\"tid\":" << tid << ",\"ts\":" << start
+            << ",\"dur\":" << end - start;
+
+        if(work) out << ",\"args\":{\"work\":" << work << "}";
+        out << "},\n";
+    }
+
+    // Finishes the file when the program exits
+    struct Closer { ~Closer() { stop_trace(); } } closer;
+}
+
+
+void start_trace(const std::string& filename) {
+    std::lock_guard<std::mutex> guard(lock);
+    if(out.is_open()) out.close();
+
+    out.open(filename, std::ios::trunc);
+    if(!out.is_open()) {
+        throw std::runtime_error("Could not open trace " + filename);
+    }
+
+    epoch = Clock::now();
+    out << "[\n";
+    tracing = true;
+}
+
+
+void stop_trace() {
+    std::lock_guard<std::mutex> guard(lock);
+    if(!out.is_open()) return;
+
+    tracing = false;
+    // Something without a trailing comma, to close the list with
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << getpid()
+        << ",\"args\":{\"name\":\"brutefordle\"}}\n]\n";
+    out.close();
+}
+
+
+TraceSpan::TraceSpan(const char* n, size_t w) : name(n), work(w), start(-1) {
+    if(!tracing.load(std::memory_order_relaxed)) return;
+
+    if(!tid) tid = next_tid++;
+    depth++;
+    start = now();
+}
+
+
+TraceSpan::~TraceSpan() {
+    if(start < 0) return;
+    int64_t end = now();
+    depth--;
+
+    std::lock_guard<std::mutex> guard(lock);
+    if(!out.is_open()) return;
+
+    write_span(name, work, start, end);
+    if(depth == 0) out.flush();
+}
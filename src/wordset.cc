@@ -0,0 +1,251 @@
+#include "wordset.h"
+
+#include <algorithm>
+
+
+namespace {
+    // 64 bit words in the bitmap of a block
+    const size_t BITMAP_WORDS = WORDSET_BLOCK / 64;
+
+    // Sets bits first up to and including last
+    void set_range(std::vector<uint64_t>& bits, size_t first, size_t last) {
+        for(size_t w = first / 64; w <= last / 64; w++) {
+            uint64_t m = ~uint64_t(0);
+            if(w == first / 64) m &= ~uint64_t(0) << (first % 64);
+            if(w == last / 64) m &= ~uint64_t(0) >> (63 - last % 64);
+            bits[w] |= m;
+        }
+    }
+}
+
+
+WordSet::WordSet(std::span<const uint32_t> sorted) {
+    for(size_t i = 0; i < sorted.size(); ) {
+        const uint16_t key = sorted[i] >> 16;
+
+        std::vector<uint16_t> low;
+        for(; i < sorted.size() && (sorted[i] >> 16) == key; i++) {
+            low.push_back(uint16_t(sorted[i]));
+        }
+
+        blocks.push_back(from_array(key, std::move(low)));
+        count += blocks.back().count;
+    }
+}
+
+
+WordSet WordSet::all(size_t n) {
+    WordSet res;
+
+    for(size_t base = 0; base < n; base += WORDSET_BLOCK) {
+        const uint32_t c = std::min<size_t>(n - base, WORDSET_BLOCK);
+        Block b = {uint16_t(base >> 16), WORDSET_RUNS, c, {}, {}, {}};
+        b.runs.push_back({0, uint16_t(c - 1)});
+
+        res.blocks.push_back(std::move(b));
+    }
+
+    res.count = n;
+    return res;
+}
+
+
+bool WordSet::contains(uint32_t i) const {
+    auto b = std::lower_bound(
+        blocks.begin(), blocks.end(), uint16_t(i >> 16),
+        [](const Block& b, uint16_t key) { return b.key < key; }
+    );
+
+    return b != blocks.end() && b->key == (i >> 16)
+        && b->contains(uint16_t(i));
+}
+
+
+WordSet& WordSet::operator&=(const WordSet& other) {
+    std::vector<Block> kept;
+    count = 0;
+
+    auto o = other.blocks.begin();
+    for(auto &b : blocks) {
+        o = std::lower_bound(
+            o, other.blocks.end(), b.key,
+            [](const Block& b, uint16_t key) { return b.key < key; }
+        );
+        if(o == other.blocks.end()) break;
+        if(o->key != b.key) continue;
+
+        Block both = intersect(b, *o);
+        if(both.count == 0) continue;
+
+        count += both.count;
+        kept.push_back(std::move(both));
+    }
+
+    blocks = std::move(kept);
+    return *this;
+}
+
+
+WordSet::Block WordSet::intersect(const Block& a, const Block& b) {
+    // An array on either side: what the smaller array has, that the
+    // other block has as well
+    if(a.form == WORDSET_ARRAY || b.form == WORDSET_ARRAY) {
+        const bool a_small = a.form == WORDSET_ARRAY
+            && (b.form != WORDSET_ARRAY || a.count <= b.count);
+        const Block& small = a_small ? a : b;
+        const Block& other = a_small ? b : a;
+
+        std::vector<uint16_t> low;
+        if(other.form == WORDSET_ARRAY) {
+            std::set_intersection(
+                small.array.begin(), small.array.end(),
+                other.array.begin(), other.array.end(),
+                std::back_inserter(low)
+            );
+        }
+
+        else {
+            for(auto l : small.array) if(other.contains(l)) low.push_back(l);
+        }
+
+        return from_array(a.key, std::move(low));
+    }
+
+    Block res = {a.key, WORDSET_BITMAP, 0, {}, {}, {}};
+
+    // Both runs: where the intervals overlap
+    if(a.form == WORDSET_RUNS && b.form == WORDSET_RUNS) {
+        res.form = WORDSET_RUNS;
+        auto i = a.runs.begin(), j = b.runs.begin();
+
+        while(i != a.runs.end() && j != b.runs.end()) {
+            const uint16_t first = std::max(i->first, j->first);
+            const uint16_t last = std::min(i->second, j->second);
+
+            if(first <= last) {
+                res.runs.push_back({first, last});
+                res.count += last - first + 1;
+            }
+
+            // Whichever ends first cannot overlap anything further on
+            if(i->second < j->second) i++;
+            else j++;
+        }
+    }
+
+    // Bitmaps and runs: the runs as a bitmap, and the two combined
+    else {
+        auto as_bits = [](const Block& b) {
+            if(b.form == WORDSET_BITMAP) return b.bits;
+
+            std::vector<uint64_t> bits(BITMAP_WORDS, 0);
+            for(auto [first, last] : b.runs) set_range(bits, first, last);
+            return bits;
+        };
+
+        res.bits = as_bits(a);
+        const std::vector<uint64_t> other = as_bits(b);
+
+        for(size_t w = 0; w < BITMAP_WORDS; w++) {
+            res.bits[w] &= other[w];
+            res.count += std::popcount(res.bits[w]);
+        }
+    }
+
+    res.settle();
+    return res;
+}
+
+
+WordSet::Block WordSet::from_array(uint16_t key, std::vector<uint16_t> low) {
+    Block res = {key, WORDSET_ARRAY, uint32_t(low.size()), {}, {}, {}};
+    res.array = std::move(low);
+    res.settle();
+    return res;
+}
+
+
+bool WordSet::Block::contains(uint16_t low) const {
+    switch(form) {
+        case WORDSET_ARRAY:
+            return std::binary_search(array.begin(), array.end(), low);
+
+        case WORDSET_BITMAP:
+            return (bits[low / 64] >> (low % 64)) & 1;
+
+        default: {
+            // The last run that starts at or before low
+            auto r = std::upper_bound(
+                runs.begin(), runs.end(), low,
+                [](uint16_t low, auto& run) { return low < run.first; }
+            );
+            return r != runs.begin() && low <= std::prev(r)->second;
+        }
+    }
+}
+
+
+void WordSet::Block::settle() {
+    // How many runs it would take
+    size_t run_c = 0;
+    switch(form) {
+        case WORDSET_ARRAY:
+            for(size_t i = 0; i < array.size(); i++) {
+                run_c += i == 0 || array[i] != array[i - 1] + 1;
+            }
+            break;
+
+        // A run starts at every bit that is set, after one that is not
+        case WORDSET_BITMAP:
+            for(size_t w = 0; w < bits.size(); w++) {
+                uint64_t before = (bits[w] << 1) | (w ? bits[w - 1] >> 63 : 0);
+                run_c += std::popcount(bits[w] & ~before);
+            }
+            break;
+
+        case WORDSET_RUNS:
+            run_c = runs.size();
+            break;
+    }
+
+    // Bytes of each form: 2 per index, the full bitmap, or 4 per run
+    int best = count <= WORDSET_ARRAY_MAX ? WORDSET_ARRAY : WORDSET_BITMAP;
+    if(run_c * 4 < std::min<size_t>(count * 2, WORDSET_BLOCK / 8)) {
+        best = WORDSET_RUNS;
+    }
+    if(best == form) return;
+
+    std::vector<uint16_t> a;
+    std::vector<uint64_t> m;
+    std::vector<std::pair<uint16_t, uint16_t>> r;
+
+    switch(best) {
+        case WORDSET_ARRAY:
+            a.reserve(count);
+            for_each([&](uint16_t low) { a.push_back(low); });
+            break;
+
+        case WORDSET_BITMAP:
+            m.assign(BITMAP_WORDS, 0);
+            for_each([&](uint16_t low) {
+                m[low / 64] |= uint64_t(1) << (low % 64);
+            });
+            break;
+
+        case WORDSET_RUNS:
+            r.reserve(run_c);
+            for_each([&](uint16_t low) {
+                // (Extends the last run, if low comes right after it)
+                if(!r.empty() && r.back().second + 1 == low) {
+                    r.back().second = low;
+                }
+                else r.push_back({low, low});
+            });
+            break;
+    }
+
+    array = std::move(a);
+    bits = std::move(m);
+    runs = std::move(r);
+    form = best;
+}
@@ -0,0 +1,31 @@
+#include "wordtable.h"
+#include "memstats.h"
+
+#include <algorithm>
+#include <numeric>
+
+
+WordTable::WordTable(const std::list<std::string>& w, size_t wlen) :
+    wlen(wlen), letters(0)
+{
+    MemoryScope scope(MEM_WORDS);
+    words.reserve(w.size() * wlen);
+    for(auto &word : w) words += word;
+
+    for(auto &c : words) letters = std::max(letters, letter_index(c) + 1);
+    letter_c.assign(w.size() * letters, 0);
+    masks.reserve(w.size());
+
+    for(size_t i = 0; i < w.size(); i++) {
+        masks.push_back(
+            letter_counts(word(i), wlen, &letter_c[i * letters])
+        );
+    }
+}
+
+
+std::vector<uint32_t> WordTable::all() const {
+    std::vector<uint32_t> res(size());
+    std::iota(res.begin(), res.end(), 0);
+    return res;
+}